@@ -0,0 +1,369 @@
+#include "event_bus.h"
+#include <string.h>
+
+#define BUS_INIT_TABLE_SIZE    64
+
+// FNV-1a, only used when a topic name has to be turned into an id.
+static uint32_t topic_hash(const char* topic, size_t length)
+{
+    uint32_t h = 2166136261u;
+    size_t i;
+    for (i = 0; i < length; i++)
+    {
+        h ^= (unsigned char)topic[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static bool pattern_matches(const EventBusPattern* pattern, const EventBusTopic* topic)
+{
+    if (pattern->wildcard)
+    {
+        return topic->length >= pattern->length &&
+               memcmp(topic->name, pattern->prefix, pattern->length) == 0;
+    }
+    return topic->length == pattern->length &&
+           memcmp(topic->name, pattern->prefix, pattern->length) == 0;
+}
+
+static bool pattern_handle_add(EventBusPattern* pattern, uint32_t topic, EventHandle handle)
+{
+    if (pattern->handle_count == pattern->handle_capacity)
+    {
+        size_t new_capacity = pattern->handle_capacity ? pattern->handle_capacity * 2 : INIT_CAPACITY;
+        EventBusPatternHandle* handles = realloc(pattern->handles, new_capacity * sizeof(*handles));
+        if (handles == NULL)
+        {
+            return false;
+        }
+        pattern->handles = handles;
+        pattern->handle_capacity = new_capacity;
+    }
+    pattern->handles[pattern->handle_count].topic = topic;
+    pattern->handles[pattern->handle_count].handle = handle;
+    pattern->handle_count++;
+    return true;
+}
+
+// Subscribes the pattern's handler to one topic and remembers the handle.
+static bool pattern_subscribe(EventBusPattern* pattern, Event* event, uint32_t topic)
+{
+    EventHandle handle = event_subscribe(event, pattern->handler);
+
+    if (!event_handle_valid(handle))
+    {
+        return false;
+    }
+    if (!pattern_handle_add(pattern, topic, handle))
+    {
+        event_unsubscribe_handle(event, handle);
+        return false;
+    }
+    return true;
+}
+
+// Removes the pattern's subscriptions made from handles[first] on.
+static void pattern_unsubscribe_from(EventBus* bus, EventBusPattern* pattern, size_t first)
+{
+    size_t i;
+
+    for (i = first; i < pattern->handle_count; i++)
+    {
+        event_unsubscribe_handle(bus->events[pattern->handles[i].topic], pattern->handles[i].handle);
+    }
+    pattern->handle_count = first;
+}
+
+static void table_insert(uint32_t* table, size_t table_size, uint32_t hash, uint32_t id)
+{
+    size_t mask = table_size - 1;
+    size_t i = hash & mask;
+    while (table[i] != 0)
+    {
+        i = (i + 1) & mask;
+    }
+    table[i] = id + 1;
+}
+
+// Keeps the load factor at or below one half.
+static bool table_reserve(EventBus* bus, size_t topics)
+{
+    size_t new_size = bus->table_size;
+    uint32_t* new_table;
+    size_t i;
+
+    while (topics * 2 > new_size)
+    {
+        new_size *= 2;
+    }
+    if (new_size == bus->table_size)
+    {
+        return true;
+    }
+
+    new_table = calloc(new_size, sizeof(*new_table));
+    if (new_table == NULL)
+    {
+        return false;
+    }
+    for (i = 0; i < bus->topic_count; i++)
+    {
+        table_insert(new_table, new_size, bus->topics[i].hash, (uint32_t)i);
+    }
+    free(bus->table);
+    bus->table = new_table;
+    bus->table_size = new_size;
+    return true;
+}
+
+static uint32_t find(const EventBus* bus, const char* topic, size_t length, uint32_t hash)
+{
+    size_t mask = bus->table_size - 1;
+    size_t i = hash & mask;
+
+    while (bus->table[i] != 0)
+    {
+        const EventBusTopic* entry = &bus->topics[bus->table[i] - 1];
+        if (entry->hash == hash && entry->length == length &&
+            memcmp(entry->name, topic, length) == 0)
+        {
+            return bus->table[i] - 1;
+        }
+        i = (i + 1) & mask;
+    }
+    return EVENT_BUS_INVALID_TOPIC;
+}
+
+bool event_bus_initialize(EventBus* bus)
+{
+    memset(bus, 0, sizeof(*bus));
+    bus->table = calloc(BUS_INIT_TABLE_SIZE, sizeof(*bus->table));
+    if (bus->table == NULL)
+    {
+        return false;
+    }
+    bus->table_size = BUS_INIT_TABLE_SIZE;
+    return true;
+}
+
+void event_bus_deinitialize(EventBus* bus)
+{
+    size_t i;
+
+    for (i = 0; i < bus->topic_count; i++)
+    {
+        event_deinitialize(bus->events[i]);
+        free(bus->events[i]);
+        free(bus->topics[i].name);
+    }
+    for (i = 0; i < bus->pattern_count; i++)
+    {
+        free(bus->patterns[i].prefix);
+        free(bus->patterns[i].handles);
+    }
+    free(bus->events);
+    free(bus->topics);
+    free(bus->patterns);
+    free(bus->table);
+    memset(bus, 0, sizeof(*bus));
+}
+
+uint32_t event_bus_lookup(const EventBus* bus, const char* topic)
+{
+    size_t length = strlen(topic);
+    return find(bus, topic, length, topic_hash(topic, length));
+}
+
+uint32_t event_bus_intern(EventBus* bus, const char* topic)
+{
+    size_t length = strlen(topic);
+    uint32_t hash = topic_hash(topic, length);
+    uint32_t id = find(bus, topic, length, hash);
+    EventBusTopic* entry;
+    Event* event;
+    size_t i;
+
+    if (id != EVENT_BUS_INVALID_TOPIC)
+    {
+        return id;
+    }
+    if (bus->topic_count >= EVENT_BUS_INVALID_TOPIC - 1)
+    {
+        return EVENT_BUS_INVALID_TOPIC;
+    }
+
+    if (bus->topic_count == bus->topic_capacity)
+    {
+        size_t new_capacity = bus->topic_capacity ? bus->topic_capacity * 2 : INIT_CAPACITY;
+        Event** new_events = realloc(bus->events, new_capacity * sizeof(*new_events));
+        EventBusTopic* new_topics;
+
+        if (new_events == NULL)
+        {
+            return EVENT_BUS_INVALID_TOPIC;
+        }
+        bus->events = new_events;
+        new_topics = realloc(bus->topics, new_capacity * sizeof(*new_topics));
+        if (new_topics == NULL)
+        {
+            return EVENT_BUS_INVALID_TOPIC;
+        }
+        bus->topics = new_topics;
+        bus->topic_capacity = new_capacity;
+    }
+    if (!table_reserve(bus, bus->topic_count + 1))
+    {
+        return EVENT_BUS_INVALID_TOPIC;
+    }
+
+    // Events are allocated one by one because an initialized Event must
+    // not move when the id arrays grow.
+    event = malloc(sizeof(*event));
+    entry = &bus->topics[bus->topic_count];
+    entry->name = malloc(length + 1);
+    if (event == NULL || entry->name == NULL)
+    {
+        free(event);
+        free(entry->name);
+        return EVENT_BUS_INVALID_TOPIC;
+    }
+    memcpy(entry->name, topic, length + 1);
+    entry->length = length;
+    entry->hash = hash;
+    event_initialize(event);
+
+    // Matching patterns subscribe before the topic becomes visible, so a
+    // failure only has to drop the handles appended for this topic.
+    id = (uint32_t)bus->topic_count;
+    for (i = 0; i < bus->pattern_count; i++)
+    {
+        EventBusPattern* pattern = &bus->patterns[i];
+        if (pattern_matches(pattern, entry) && !pattern_subscribe(pattern, event, id))
+        {
+            while (i-- > 0)
+            {
+                pattern = &bus->patterns[i];
+                if (pattern->handle_count > 0 && pattern->handles[pattern->handle_count - 1].topic == id)
+                {
+                    pattern->handle_count--;
+                }
+            }
+            event_deinitialize(event);
+            free(event);
+            free(entry->name);
+            return EVENT_BUS_INVALID_TOPIC;
+        }
+    }
+
+    bus->topic_count++;
+    bus->events[id] = event;
+    table_insert(bus->table, bus->table_size, hash, id);
+    return id;
+}
+
+Event* event_bus_event(const EventBus* bus, uint32_t topic_id)
+{
+    return topic_id < bus->topic_count ? bus->events[topic_id] : NULL;
+}
+
+EventHandle event_bus_subscribe(EventBus* bus, const char* topic, EventHandler handler)
+{
+    EventHandle invalid = { EVENT_INVALID_SLOT, 0 };
+    uint32_t id = event_bus_intern(bus, topic);
+
+    if (id == EVENT_BUS_INVALID_TOPIC)
+    {
+        return invalid;
+    }
+    return event_subscribe(bus->events[id], handler);
+}
+
+bool event_bus_unsubscribe(EventBus* bus, uint32_t topic_id, EventHandle handle)
+{
+    Event* event = event_bus_event(bus, topic_id);
+    return event ? event_unsubscribe_handle(event, handle) : false;
+}
+
+static void parse_pattern(const char* pattern, EventBusPattern* out)
+{
+    size_t length = strlen(pattern);
+
+    out->wildcard = length > 0 && pattern[length - 1] == '*';
+    out->length = out->wildcard ? length - 1 : length;
+}
+
+bool event_bus_subscribe_pattern(EventBus* bus, const char* pattern, EventHandler handler)
+{
+    EventBusPattern* entry;
+    size_t i;
+
+    if (bus->pattern_count == bus->pattern_capacity)
+    {
+        size_t new_capacity = bus->pattern_capacity ? bus->pattern_capacity * 2 : INIT_CAPACITY;
+        EventBusPattern* new_patterns = realloc(bus->patterns, new_capacity * sizeof(*new_patterns));
+        if (new_patterns == NULL)
+        {
+            return false;
+        }
+        bus->patterns = new_patterns;
+        bus->pattern_capacity = new_capacity;
+    }
+
+    entry = &bus->patterns[bus->pattern_count];
+    parse_pattern(pattern, entry);
+    entry->prefix = malloc(entry->length + 1);
+    if (entry->prefix == NULL)
+    {
+        return false;
+    }
+    memcpy(entry->prefix, pattern, entry->length);
+    entry->prefix[entry->length] = '\0';
+    entry->handler = handler;
+    entry->handles = NULL;
+    entry->handle_count = 0;
+    entry->handle_capacity = 0;
+
+    // Matching is resolved here and when new topics are interned, so
+    // notify never looks at patterns.
+    for (i = 0; i < bus->topic_count; i++)
+    {
+        if (pattern_matches(entry, &bus->topics[i]) &&
+            !pattern_subscribe(entry, bus->events[i], (uint32_t)i))
+        {
+            pattern_unsubscribe_from(bus, entry, 0);
+            free(entry->handles);
+            free(entry->prefix);
+            return false;
+        }
+    }
+    bus->pattern_count++;
+    return true;
+}
+
+bool event_bus_unsubscribe_pattern(EventBus* bus, const char* pattern, EventHandler handler)
+{
+    EventBusPattern key;
+    size_t i;
+
+    parse_pattern(pattern, &key);
+    for (i = 0; i < bus->pattern_count; i++)
+    {
+        EventBusPattern* entry = &bus->patterns[i];
+        if (entry->handler == handler && entry->wildcard == key.wildcard &&
+            entry->length == key.length && memcmp(entry->prefix, pattern, key.length) == 0)
+        {
+            pattern_unsubscribe_from(bus, entry, 0);
+            free(entry->handles);
+            free(entry->prefix);
+            bus->patterns[i] = bus->patterns[--bus->pattern_count];
+            return true;
+        }
+    }
+    return false;
+}
+
+void event_bus_notify_topic(const EventBus* bus, const char* topic, const void* data, size_t length)
+{
+    event_bus_notify(bus, event_bus_lookup(bus, topic), data, length);
+}
@@ -0,0 +1,404 @@
+#include "event_dispatcher.h"
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+
+#define SPIN_BEFORE_SLEEP    64
+
+typedef enum QueueResult
+{
+    QUEUE_OK,
+    QUEUE_FULL,
+    QUEUE_EMPTY,
+    QUEUE_RELIABLE    // the oldest message must not be dropped
+}QueueResult;
+
+// A message taken off the ring; the cell itself is released immediately so
+// producers are not held up by slow handlers.
+typedef struct DequeuedMessage
+{
+    Event* event;
+    void* heap_data;
+    size_t length;
+    unsigned long long enqueue_ns;
+    unsigned char inline_data[EVENT_ASYNC_INLINE_PAYLOAD];
+}DequeuedMessage;
+
+static unsigned long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static size_t round_up_pow2(size_t n)
+{
+    size_t p = 1;
+    while (p < n)
+    {
+        p <<= 1;
+    }
+    return p;
+}
+
+// Claims the cell at the tail; it reaches the consumers once its sequence
+// is advanced by event_async_commit().
+static QueueResult queue_claim(EventDispatcher* d, EventQueueCell** claimed, unsigned long long* position)
+{
+    EventQueueCell* cell;
+    unsigned long long pos = __atomic_load_n(&d->enqueue_pos, __ATOMIC_RELAXED);
+
+    for (;;)
+    {
+        unsigned long long seq;
+        long long dif;
+
+        cell = &d->cells[pos & d->mask];
+        seq = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        dif = (long long)(seq - pos);
+        if (dif == 0)
+        {
+            if (__atomic_compare_exchange_n(&d->enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (dif < 0)
+        {
+            return QUEUE_FULL;
+        }
+        else
+        {
+            pos = __atomic_load_n(&d->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    *claimed = cell;
+    *position = pos;
+    return QUEUE_OK;
+}
+
+// With keep_reliable (dropping for DROP_OLDEST), a reliable message at the
+// head is left in place and QUEUE_RELIABLE returned.
+static QueueResult queue_pop(EventDispatcher* d, DequeuedMessage* msg, bool keep_reliable)
+{
+    EventQueueCell* cell;
+    unsigned long long pos = __atomic_load_n(&d->dequeue_pos, __ATOMIC_RELAXED);
+
+    for (;;)
+    {
+        unsigned long long seq;
+        long long dif;
+
+        cell = &d->cells[pos & d->mask];
+        seq = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        dif = (long long)(seq - (pos + 1));
+        if (dif == 0)
+        {
+            if (keep_reliable && __atomic_load_n(&cell->reliable, __ATOMIC_RELAXED))
+            {
+                return QUEUE_RELIABLE;
+            }
+            if (__atomic_compare_exchange_n(&d->dequeue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (dif < 0)
+        {
+            return QUEUE_EMPTY;
+        }
+        else
+        {
+            pos = __atomic_load_n(&d->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    msg->event = cell->event;
+    msg->length = cell->length;
+    msg->enqueue_ns = cell->enqueue_ns;
+    msg->heap_data = cell->heap_data;
+    if (msg->heap_data == NULL && msg->length > 0)
+    {
+        memcpy(msg->inline_data, cell->inline_data, msg->length);
+    }
+    __atomic_store_n(&cell->sequence, pos + d->mask + 1, __ATOMIC_RELEASE);
+    return QUEUE_OK;
+}
+
+static size_t queue_depth(EventDispatcher* d)
+{
+    unsigned long long head = __atomic_load_n(&d->dequeue_pos, __ATOMIC_SEQ_CST);
+    unsigned long long tail = __atomic_load_n(&d->enqueue_pos, __ATOMIC_SEQ_CST);
+    return tail > head ? (size_t)(tail - head) : 0;
+}
+
+static void wake_one(EventDispatcher* d, int* sleepers, pthread_cond_t* cond)
+{
+    if (__atomic_load_n(sleepers, __ATOMIC_SEQ_CST) > 0)
+    {
+        pthread_mutex_lock(&d->lock);
+        pthread_cond_signal(cond);
+        pthread_mutex_unlock(&d->lock);
+    }
+}
+
+static void store_max(unsigned long long* max_ns, unsigned long long value)
+{
+    unsigned long long max = __atomic_load_n(max_ns, __ATOMIC_RELAXED);
+
+    while (value > max &&
+           !__atomic_compare_exchange_n(max_ns, &max, value, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+static void record_latency(EventDispatcher* d, unsigned long long queued, unsigned long long latency)
+{
+    __atomic_fetch_add(&d->dispatched, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&d->queue_total_ns, queued, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&d->latency_total_ns, latency, __ATOMIC_RELAXED);
+    store_max(&d->queue_max_ns, queued);
+    store_max(&d->latency_max_ns, latency);
+}
+
+static void* dispatcher_thread(void* arg)
+{
+    EventDispatcher* d = arg;
+    DequeuedMessage msg;
+    int spins = 0;
+
+    for (;;)
+    {
+        if (queue_pop(d, &msg, false) == QUEUE_OK)
+        {
+            const void* data = msg.heap_data ? msg.heap_data : msg.inline_data;
+            unsigned long long picked = now_ns();
+
+            spins = 0;
+            wake_one(d, &d->sleeping_producers, &d->not_full);
+            event_notify(msg.event, data, msg.length);
+            record_latency(d, picked - msg.enqueue_ns, now_ns() - msg.enqueue_ns);
+            free(msg.heap_data);
+            continue;
+        }
+
+        if (++spins < SPIN_BEFORE_SLEEP)
+        {
+            sched_yield();
+            continue;
+        }
+
+        // Park. The sleeper count is raised before re-checking the queue so
+        // a producer either sees us sleeping or we see its message.
+        pthread_mutex_lock(&d->lock);
+        __atomic_add_fetch(&d->sleeping_workers, 1, __ATOMIC_SEQ_CST);
+        while (queue_depth(d) == 0 && !d->stopping)
+        {
+            pthread_cond_wait(&d->not_empty, &d->lock);
+        }
+        __atomic_sub_fetch(&d->sleeping_workers, 1, __ATOMIC_SEQ_CST);
+        if (d->stopping && queue_depth(d) == 0)
+        {
+            pthread_mutex_unlock(&d->lock);
+            break;
+        }
+        pthread_mutex_unlock(&d->lock);
+        spins = 0;
+    }
+    return NULL;
+}
+
+bool event_dispatcher_initialize(EventDispatcher* dispatcher, size_t capacity,
+                                 size_t worker_count, EventBackpressure policy)
+{
+    size_t i;
+
+    memset(dispatcher, 0, sizeof(*dispatcher));
+    capacity = round_up_pow2(capacity < 2 ? 2 : capacity);
+    if (worker_count == 0)
+    {
+        worker_count = 1;
+    }
+
+    dispatcher->cells = malloc(capacity * sizeof(*dispatcher->cells));
+    dispatcher->workers = malloc(worker_count * sizeof(*dispatcher->workers));
+    if (dispatcher->cells == NULL || dispatcher->workers == NULL)
+    {
+        free(dispatcher->cells);
+        free(dispatcher->workers);
+        return false;
+    }
+    for (i = 0; i < capacity; i++)
+    {
+        dispatcher->cells[i].sequence = i;
+    }
+    dispatcher->mask = capacity - 1;
+    dispatcher->policy = policy;
+
+    pthread_mutex_init(&dispatcher->lock, NULL);
+    pthread_cond_init(&dispatcher->not_empty, NULL);
+    pthread_cond_init(&dispatcher->not_full, NULL);
+
+    for (i = 0; i < worker_count; i++)
+    {
+        if (pthread_create(&dispatcher->workers[i], NULL, dispatcher_thread, dispatcher) != 0)
+        {
+            break;
+        }
+    }
+    dispatcher->worker_count = i;
+    if (i == 0)
+    {
+        event_dispatcher_deinitialize(dispatcher);
+        return false;
+    }
+    return true;
+}
+
+void event_dispatcher_deinitialize(EventDispatcher* dispatcher)
+{
+    DequeuedMessage msg;
+    size_t i;
+
+    pthread_mutex_lock(&dispatcher->lock);
+    dispatcher->stopping = true;
+    pthread_cond_broadcast(&dispatcher->not_empty);
+    pthread_cond_broadcast(&dispatcher->not_full);
+    pthread_mutex_unlock(&dispatcher->lock);
+
+    for (i = 0; i < dispatcher->worker_count; i++)
+    {
+        pthread_join(dispatcher->workers[i], NULL);
+    }
+
+    // Only reachable with messages left if no worker could be started.
+    while (queue_pop(dispatcher, &msg, false) == QUEUE_OK)
+    {
+        free(msg.heap_data);
+    }
+
+    pthread_cond_destroy(&dispatcher->not_full);
+    pthread_cond_destroy(&dispatcher->not_empty);
+    pthread_mutex_destroy(&dispatcher->lock);
+    free(dispatcher->workers);
+    free(dispatcher->cells);
+    dispatcher->workers = NULL;
+    dispatcher->cells = NULL;
+    dispatcher->worker_count = 0;
+}
+
+bool event_async_reserve(EventDispatcher* dispatcher, Event* event, size_t length,
+                         bool reliable, EventAsyncSlot* slot)
+{
+    EventBackpressure policy = reliable ? EVENT_BACKPRESSURE_BLOCK : dispatcher->policy;
+    EventQueueCell* cell;
+    void* heap_data = NULL;
+    unsigned long long stamp = now_ns();
+
+    if (__atomic_load_n(&dispatcher->stopping, __ATOMIC_RELAXED))
+    {
+        return false;
+    }
+    if (length > EVENT_ASYNC_INLINE_PAYLOAD)
+    {
+        heap_data = malloc(length);
+        if (heap_data == NULL)
+        {
+            return false;
+        }
+    }
+
+    while (queue_claim(dispatcher, &slot->cell, &slot->position) == QUEUE_FULL)
+    {
+        DequeuedMessage victim;
+        QueueResult oldest;
+
+        switch (policy)
+        {
+            case EVENT_BACKPRESSURE_DROP_NEWEST:
+                __atomic_fetch_add(&dispatcher->dropped, 1, __ATOMIC_RELAXED);
+                free(heap_data);
+                return false;
+
+            case EVENT_BACKPRESSURE_DROP_OLDEST:
+                oldest = queue_pop(dispatcher, &victim, true);
+                if (oldest == QUEUE_RELIABLE)
+                {
+                    __atomic_fetch_add(&dispatcher->dropped, 1, __ATOMIC_RELAXED);
+                    free(heap_data);
+                    return false;
+                }
+                if (oldest == QUEUE_OK)
+                {
+                    __atomic_fetch_add(&dispatcher->dropped, 1, __ATOMIC_RELAXED);
+                    free(victim.heap_data);
+                }
+                break;
+
+            case EVENT_BACKPRESSURE_BLOCK:
+            default:
+                pthread_mutex_lock(&dispatcher->lock);
+                __atomic_add_fetch(&dispatcher->sleeping_producers, 1, __ATOMIC_SEQ_CST);
+                while (queue_depth(dispatcher) > dispatcher->mask && !dispatcher->stopping)
+                {
+                    pthread_cond_wait(&dispatcher->not_full, &dispatcher->lock);
+                }
+                __atomic_sub_fetch(&dispatcher->sleeping_producers, 1, __ATOMIC_SEQ_CST);
+                pthread_mutex_unlock(&dispatcher->lock);
+                if (__atomic_load_n(&dispatcher->stopping, __ATOMIC_RELAXED))
+                {
+                    free(heap_data);
+                    return false;
+                }
+                break;
+        }
+    }
+
+    cell = slot->cell;
+    cell->event = event;
+    cell->length = length;
+    cell->enqueue_ns = stamp;
+    cell->heap_data = heap_data;
+    __atomic_store_n(&cell->reliable, reliable, __ATOMIC_RELAXED);
+    slot->data = heap_data ? heap_data : cell->inline_data;
+    return true;
+}
+
+void event_async_commit(EventDispatcher* dispatcher, EventAsyncSlot* slot)
+{
+    __atomic_store_n(&slot->cell->sequence, slot->position + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&dispatcher->enqueued, 1, __ATOMIC_RELAXED);
+    wake_one(dispatcher, &dispatcher->sleeping_workers, &dispatcher->not_empty);
+}
+
+bool event_notify_async(EventDispatcher* dispatcher, Event* event, const void* data, size_t length)
+{
+    EventAsyncSlot slot;
+
+    if (!event_async_reserve(dispatcher, event, length, false, &slot))
+    {
+        return false;
+    }
+    if (length > 0)
+    {
+        memcpy(slot.data, data, length);
+    }
+    event_async_commit(dispatcher, &slot);
+    return true;
+}
+
+void event_dispatcher_get_stats(EventDispatcher* dispatcher, EventDispatchStats* stats)
+{
+    stats->depth = queue_depth(dispatcher);
+    stats->enqueued = __atomic_load_n(&dispatcher->enqueued, __ATOMIC_RELAXED);
+    stats->dispatched = __atomic_load_n(&dispatcher->dispatched, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&dispatcher->dropped, __ATOMIC_RELAXED);
+    stats->queue_total_ns = __atomic_load_n(&dispatcher->queue_total_ns, __ATOMIC_RELAXED);
+    stats->queue_max_ns = __atomic_load_n(&dispatcher->queue_max_ns, __ATOMIC_RELAXED);
+    stats->latency_total_ns = __atomic_load_n(&dispatcher->latency_total_ns, __ATOMIC_RELAXED);
+    stats->latency_max_ns = __atomic_load_n(&dispatcher->latency_max_ns, __ATOMIC_RELAXED);
+}
@@ -1,70 +1,1329 @@
 #include "event_notifier.h"
+#include "event_stats.h"
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+
+#define CACHE_LINE_SIZE    64
+
+// Grace-period tracking shared by all concurrent events. Every thread that
+// notifies owns one slot on its own cache line and publishes the epoch it
+// entered with (0 = not reading). A writer that swapped out a snapshot bumps
+// the global epoch and waits until no slot still holds an older one.
+typedef struct ReaderSlot
+{
+    unsigned long long epoch;
+    int owned;
+    char pad[CACHE_LINE_SIZE - sizeof(unsigned long long) - sizeof(int)];
+}ReaderSlot;
+
+static ReaderSlot reader_slots[EVENT_MAX_READERS] __attribute__((aligned(CACHE_LINE_SIZE)));
+static unsigned long long global_epoch = 1;
+static int reader_slots_high;
+static pthread_once_t reader_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t reader_key;
+
+static __thread int reader_slot = -1;
+static __thread unsigned int reader_depth;
+
+static void reader_slot_release(void* arg)
+{
+    int slot = (int)(size_t)arg - 1;
+    __atomic_store_n(&reader_slots[slot].epoch, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&reader_slots[slot].owned, 0, __ATOMIC_RELEASE);
+}
+
+static void reader_key_create(void)
+{
+    pthread_key_create(&reader_key, reader_slot_release);
+}
+
+static int reader_slot_get(void)
+{
+    int i;
+    if (reader_slot >= 0)
+    {
+        return reader_slot;
+    }
+
+    pthread_once(&reader_key_once, reader_key_create);
+    for (i = 0; i < EVENT_MAX_READERS; i++)
+    {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&reader_slots[i].owned, &expected, 1, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            int high = __atomic_load_n(&reader_slots_high, __ATOMIC_RELAXED);
+            while (high < i + 1 &&
+                   !__atomic_compare_exchange_n(&reader_slots_high, &high, i + 1, true,
+                                                __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            {
+            }
+            pthread_setspecific(reader_key, (void*)(size_t)(i + 1));
+            reader_slot = i;
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Returns the reader slot, or -1 when the caller has to take write_lock.
+static int reader_enter(void)
+{
+    int slot = reader_slot_get();
+    if (slot >= 0 && reader_depth++ == 0)
+    {
+        unsigned long long epoch = __atomic_load_n(&global_epoch, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&reader_slots[slot].epoch, epoch, __ATOMIC_SEQ_CST);
+    }
+    return slot;
+}
+
+static void reader_exit(int slot)
+{
+    if (--reader_depth == 0)
+    {
+        __atomic_store_n(&reader_slots[slot].epoch, 0, __ATOMIC_RELEASE);
+    }
+}
+
+// Blocks until every reader that could still see a snapshot unpublished
+// before this call has left event_notify().
+static void wait_for_readers(void)
+{
+    int i, high;
+    unsigned long long target = __atomic_add_fetch(&global_epoch, 1, __ATOMIC_SEQ_CST);
+
+    high = __atomic_load_n(&reader_slots_high, __ATOMIC_SEQ_CST);
+    for (i = 0; i < high; i++)
+    {
+        // A writer running inside a handler cannot wait for itself; the
+        // header forbids touching the event that is being notified.
+        if (i == reader_slot && reader_depth > 0)
+        {
+            continue;
+        }
+        for (;;)
+        {
+            unsigned long long epoch = __atomic_load_n(&reader_slots[i].epoch, __ATOMIC_SEQ_CST);
+            if (epoch == 0 || epoch >= target)
+            {
+                break;
+            }
+            sched_yield();
+        }
+    }
+}
+
+static EventSnapshot* snapshot_alloc(size_t count)
+{
+    EventSnapshot* snapshot = malloc(sizeof(*snapshot) + count * sizeof(snapshot->handlers[0]));
+    if (snapshot)
+    {
+        snapshot->count = 0;
+    }
+    return snapshot;
+}
+
+static bool is_tombstone(const EventSubscription* subscription)
+{
+    return subscription->kind == EVENT_HANDLER_NONE;
+}
+
+// Kind of an entry that notify may be reading while unsubscribe turns it
+// into a tombstone in the published snapshot.
+static inline uint32_t subscription_kind(const EventSubscription* subscription)
+{
+    return __atomic_load_n(&subscription->kind, __ATOMIC_ACQUIRE);
+}
+
+// Fills a snapshot reserved before the writer copy was modified, swaps it in
+// and frees the previous one once no reader can still hold it. The snapshot
+// is an exact copy, tombstones included, so an entry has the same index in
+// both and unsubscribe can mark it dead in place.
+static void snapshot_publish(Event* event, EventSnapshot* snapshot)
+{
+    EventSnapshot* old;
+
+    memcpy(snapshot->handlers, event->handlers, event->count * sizeof(snapshot->handlers[0]));
+    snapshot->count = event->count;
+
+    old = __atomic_exchange_n(&event->snapshot, snapshot, __ATOMIC_SEQ_CST);
+    wait_for_readers();
+    free(old);
+}
 
 void event_initialize(Event* event)
 {
-    // Write your implementation here. 
-    event->handlers = malloc(INIT_CAPACITY * sizeof(*event->handlers));
+    // Write your implementation here.
+    // Starts out in the inline buffers; the first heap allocation happens
+    // when the event outgrows them.
+    event->handlers = event->inline_handlers;
     event->count = 0;
-    event->capacity = INIT_CAPACITY;
+    event->capacity = EVENT_INLINE_HANDLERS;
+    event->tombstones = 0;
+    event->slots = event->inline_slots;
+    event->slot_count = 0;
+    event->slot_capacity = EVENT_INLINE_HANDLERS;
+    event->free_slot = EVENT_INVALID_SLOT;
+    event->notifying = 0;
+    event->unsorted = false;
+    event->concurrent = false;
+    event->snapshot = NULL;
+    event->coalescer = NULL;
 }
+
+void event_initialize_concurrent(Event* event)
+{
+    pthread_mutexattr_t attr;
+
+    event_initialize(event);
+    event->concurrent = true;
+    event->snapshot = snapshot_alloc(0);
+
+    // Recursive so that a thread without a reader slot, which notifies under
+    // the lock, can still notify the same event from inside a handler.
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&event->write_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
 void event_deinitialize(Event* event)
 {
     // Write your implementation here.
-    if (event->handlers)
+    // Pending coalesced payloads are delivered to the handlers, so this
+    // has to run while they are still there.
+    if (event->coalescer)
+    {
+        event_disable_coalescing(event);
+    }
+    if (event->handlers && event->handlers != event->inline_handlers)
     {
         free(event->handlers);
     }
+    if (event->slots != event->inline_slots)
+    {
+        free(event->slots);
+    }
+    if (event->concurrent)
+    {
+        free(event->snapshot);
+        pthread_mutex_destroy(&event->write_lock);
+    }
     event->handlers = NULL;
     event->count = 0;
     event->capacity = 0;
+    event->tombstones = 0;
+    event->slots = NULL;
+    event->slot_count = 0;
+    event->slot_capacity = 0;
+    event->free_slot = EVENT_INVALID_SLOT;
+    event->notifying = 0;
+    event->unsorted = false;
+    event->concurrent = false;
+    event->snapshot = NULL;
 }
 
-bool event_subscribe(Event* event, void (*handler)(const Event*, const void*, size_t))
+// Squeezes tombstones out of the handler array, keeping subscription order
+// and pointing each live slot at its entry's new position.
+static void compact(Event* event)
 {
-    // Write your implementation here.
+    size_t i, n = 0;
+
+    for (i = 0; i < event->count; i++)
+    {
+        if (!is_tombstone(&event->handlers[i]))
+        {
+            event->handlers[n] = event->handlers[i];
+            event->slots[event->handlers[n].slot].index = (uint32_t)n;
+            n++;
+        }
+    }
+    event->count = n;
+    event->tombstones = 0;
+}
+
+static bool compact_due(const Event* event)
+{
+    return event->tombstones >= EVENT_COMPACT_MIN_TOMBSTONES &&
+           event->tombstones * 2 >= event->count;
+}
+
+// Grows an array that may still live in the Event's inline buffer: the
+// first growth copies it to the heap, later ones realloc.
+static void* grow(void* array, const void* inline_array, size_t* capacity, size_t elem_size)
+{
+    size_t new_capacity = *capacity * 2 < INIT_CAPACITY ? INIT_CAPACITY : *capacity * 2;
+    void* new_array;
+
+    if (array == inline_array)
+    {
+        new_array = malloc(new_capacity * elem_size);
+        if (new_array)
+        {
+            memcpy(new_array, array, *capacity * elem_size);
+        }
+    }
+    else
+    {
+        new_array = realloc(array, new_capacity * elem_size);
+    }
+    if (new_array)
+    {
+        *capacity = new_capacity;
+    }
+    return new_array;
+}
+
+static uint32_t slot_acquire(Event* event)
+{
+    uint32_t slot = event->free_slot;
+
+    if (slot != EVENT_INVALID_SLOT)
+    {
+        event->free_slot = event->slots[slot].index;
+        return slot;
+    }
+
+    if (event->slot_count == event->slot_capacity)
+    {
+        EventSlot* new_slots = grow(event->slots, event->inline_slots,
+                                    &event->slot_capacity, sizeof(*new_slots));
+        if (new_slots == NULL)
+        {
+            return EVENT_INVALID_SLOT;
+        }
+        event->slots = new_slots;
+    }
+    event->slots[event->slot_count].generation = 0;
+    return (uint32_t)event->slot_count++;
+}
+
+// Keeps handlers ordered by descending priority, and by subscription order
+// within a priority, so notify just walks the array. Subscriptions with the
+// lowest priority so far (the default case) are a plain append.
+static void insert_sorted(Event* event, EventSubscription subscription)
+{
+    size_t pos = event->count;
+
+    while (pos > 0 && event->handlers[pos - 1].priority < subscription.priority)
+    {
+        event->handlers[pos] = event->handlers[pos - 1];
+        // A tombstone's slot is free or already reused by another entry.
+        if (!is_tombstone(&event->handlers[pos]))
+        {
+            event->slots[event->handlers[pos].slot].index = (uint32_t)pos;
+        }
+        pos--;
+    }
+    event->handlers[pos] = subscription;
+    event->slots[subscription.slot].index = (uint32_t)pos;
+    event->count++;
+}
+
+// Puts subscriptions appended by handlers during a notify into priority
+// order once it has ended. Runs after compaction, so every entry is live.
+static void sort_by_priority(Event* event)
+{
+    size_t i, pos;
+
+    for (i = 1; i < event->count; i++)
+    {
+        EventSubscription subscription = event->handlers[i];
+
+        for (pos = i; pos > 0 && event->handlers[pos - 1].priority < subscription.priority; pos--)
+        {
+            event->handlers[pos] = event->handlers[pos - 1];
+        }
+        event->handlers[pos] = subscription;
+    }
+    for (i = 0; i < event->count; i++)
+    {
+        event->slots[event->handlers[i].slot].index = (uint32_t)i;
+    }
+    event->unsorted = false;
+}
+
+static EventHandle subscribe_locked(Event* event, EventSubscription subscription)
+{
+    EventHandle handle = { EVENT_INVALID_SLOT, 0 };
+    EventSnapshot* snapshot = NULL;
+    uint32_t slot;
+
+    // In concurrent mode the snapshot must mirror the writer copy's layout
+    // whenever write_lock is released, so it is reserved before anything
+    // moves and published even if the subscribe fails after compacting.
+    if (event->concurrent)
+    {
+        snapshot = snapshot_alloc(event->count + 1);
+        if (snapshot == NULL)
+        {
+            return handle;
+        }
+    }
+
+    // A running notify walks the array by index, so it is only grown then.
+    if(event->count == event->capacity && event->tombstones > 0 && event->notifying == 0)
+    {
+        compact(event);
+    }
     if(event->count == event->capacity)
     {
-        size_t new_capacity = event->capacity * 2;
-        void (**new_handlers)(const Event*, const void*, size_t);
-        
-        new_handlers = realloc(event->handlers, new_capacity * sizeof(*new_handlers));
+        EventSubscription* new_handlers;
+
+        new_handlers = grow(event->handlers, event->inline_handlers,
+                            &event->capacity, sizeof(*new_handlers));
         if(new_handlers == NULL)
         {
-            return false;
+            if (snapshot)
+            {
+                snapshot_publish(event, snapshot);
+            }
+            return handle;
         }
-        
+
         event->handlers = new_handlers;
-        event->capacity = new_capacity;
     }
-    event->handlers[event->count++] = handler;
+
+    slot = slot_acquire(event);
+    if (slot == EVENT_INVALID_SLOT)
+    {
+        if (snapshot)
+        {
+            snapshot_publish(event, snapshot);
+        }
+        return handle;
+    }
+    subscription.slot = slot;
+    if (event->notifying > 0 && event->count > 0 &&
+        event->handlers[event->count - 1].priority < subscription.priority)
+    {
+        // Shifting would move entries under the running notify: append now,
+        // sort when it ends.
+        event->slots[slot].index = (uint32_t)event->count;
+        event->handlers[event->count++] = subscription;
+        event->unsorted = true;
+    }
+    else
+    {
+        insert_sorted(event, subscription);
+    }
+
+    if (snapshot)
+    {
+        snapshot_publish(event, snapshot);
+    }
+    handle.slot = slot;
+    handle.generation = event->slots[slot].generation;
+    return handle;
+}
+
+static EventHandle subscribe(Event* event, EventSubscription subscription)
+{
+    EventHandle ret;
+
+    if (!event->concurrent)
+    {
+        return subscribe_locked(event, subscription);
+    }
+
+    pthread_mutex_lock(&event->write_lock);
+    ret = subscribe_locked(event, subscription);
+    pthread_mutex_unlock(&event->write_lock);
+    return ret;
+}
+
+EventHandle event_subscribe(Event* event, void (*handler)(const Event*, const void*, size_t))
+{
+    // Write your implementation here.
+    EventSubscription subscription = { 0 };
+    subscription.handler = handler;
+    subscription.kind = EVENT_HANDLER_PLAIN;
+    return subscribe(event, subscription);
+}
+
+EventHandle event_subscribe_batch(Event* event, EventBatchHandler handler)
+{
+    EventSubscription subscription = { 0 };
+    subscription.batch_handler = handler;
+    subscription.kind = EVENT_HANDLER_BATCH;
+    return subscribe(event, subscription);
+}
+
+EventHandle event_subscribe_batch_opts(Event* event, EventBatchHandler handler,
+                                       const EventSubscribeOptions* options)
+{
+    EventSubscription subscription = { 0 };
+    subscription.batch_handler = handler;
+    subscription.kind = EVENT_HANDLER_BATCH;
+    subscription.priority = options->priority;
+    subscription.filter_mask = options->filter_mask;
+    return subscribe(event, subscription);
+}
+
+EventHandle event_subscribe_ctx(Event* event, EventContextHandler handler, void* ctx)
+{
+    EventSubscription subscription = { 0 };
+    subscription.context_handler = handler;
+    subscription.ctx = ctx;
+    subscription.kind = EVENT_HANDLER_CONTEXT;
+    return subscribe(event, subscription);
+}
+
+EventHandle event_subscribe_opts(Event* event, EventHandler handler,
+                                 const EventSubscribeOptions* options)
+{
+    EventSubscription subscription = { 0 };
+    subscription.handler = handler;
+    subscription.kind = EVENT_HANDLER_PLAIN;
+    subscription.priority = options->priority;
+    subscription.filter_mask = options->filter_mask;
+    return subscribe(event, subscription);
+}
+
+EventHandle event_subscribe_ctx_opts(Event* event, EventContextHandler handler, void* ctx,
+                                     const EventSubscribeOptions* options)
+{
+    EventSubscription subscription = { 0 };
+    subscription.context_handler = handler;
+    subscription.ctx = ctx;
+    subscription.kind = EVENT_HANDLER_CONTEXT;
+    subscription.priority = options->priority;
+    subscription.filter_mask = options->filter_mask;
+    return subscribe(event, subscription);
+}
+
+// O(1): the entry becomes a tombstone that notify skips, its slot goes on
+// the free list with a new generation so stale handles stop matching, and
+// the array is compacted once tombstones make up half of it (after the
+// outermost notify returns, if one is running). In concurrent mode the entry
+// is also marked dead in the published snapshot, and the writer waits for
+// readers that may still be calling it; only compaction copies the list.
+static bool unsubscribe_locked(Event* event, EventHandle handle)
+{
+    EventSnapshot* snapshot = NULL;
+    EventSlot* slot;
+    uint32_t index;
+
+    if (handle.slot >= event->slot_count)
+    {
+        return false;
+    }
+    slot = &event->slots[handle.slot];
+    if (slot->generation != handle.generation ||
+        slot->index >= event->count ||
+        event->handlers[slot->index].slot != handle.slot ||
+        is_tombstone(&event->handlers[slot->index]))
+    {
+        return false;
+    }
+
+    index = slot->index;
+    event->handlers[index].kind = EVENT_HANDLER_NONE;
+    event->tombstones++;
+
+    slot->generation++;
+    slot->index = event->free_slot;
+    event->free_slot = handle.slot;
+
+    if (!event->concurrent)
+    {
+        if (event->notifying == 0 && compact_due(event))
+        {
+            compact(event);
+        }
+        return true;
+    }
+
+    __atomic_store_n(&event->snapshot->handlers[index].kind, EVENT_HANDLER_NONE, __ATOMIC_RELEASE);
+    if (compact_due(event))
+    {
+        // Without memory for a compacted copy the tombstones just stay.
+        snapshot = snapshot_alloc(event->count - event->tombstones);
+    }
+    if (snapshot)
+    {
+        compact(event);
+        snapshot_publish(event, snapshot);
+    }
+    else
+    {
+        wait_for_readers();
+    }
     return true;
 }
 
+static bool unsubscribe(Event* event, EventHandle handle)
+{
+    bool ret;
+
+    if (!event->concurrent)
+    {
+        return unsubscribe_locked(event, handle);
+    }
+
+    pthread_mutex_lock(&event->write_lock);
+    ret = unsubscribe_locked(event, handle);
+    pthread_mutex_unlock(&event->write_lock);
+    return ret;
+}
+
+bool event_unsubscribe_handle(Event* event, EventHandle handle)
+{
+    return unsubscribe(event, handle);
+}
+
+// Lookup by function pointer is still a linear search; the removal itself
+// goes through the O(1) handle path.
+static bool unsubscribe_matching(Event* event, EventSubscription subscription)
+{
+    bool ret = false;
+    size_t i;
+
+    if (event->concurrent)
+    {
+        pthread_mutex_lock(&event->write_lock);
+    }
+    for( i = 0; i < event->count; i++)
+    {
+        if (event->handlers[i].kind == subscription.kind &&
+            event->handlers[i].handler == subscription.handler &&
+            event->handlers[i].ctx == subscription.ctx)
+        {
+            EventHandle handle;
+            handle.slot = event->handlers[i].slot;
+            handle.generation = event->slots[handle.slot].generation;
+            ret = unsubscribe_locked(event, handle);
+            break;
+        }
+    }
+    if (event->concurrent)
+    {
+        pthread_mutex_unlock(&event->write_lock);
+    }
+    return ret;
+}
+
 bool event_unsubscribe(Event* event, void (*handler)(const Event*, const void*, size_t))
 {
     // Write your implementation here.
-    int i, j;
-    for( i = 0; i < event->count; i++)
+    EventSubscription subscription = { 0 };
+    subscription.handler = handler;
+    subscription.kind = EVENT_HANDLER_PLAIN;
+    return unsubscribe_matching(event, subscription);
+}
+
+bool event_unsubscribe_batch(Event* event, EventBatchHandler handler)
+{
+    EventSubscription subscription = { 0 };
+    subscription.batch_handler = handler;
+    subscription.kind = EVENT_HANDLER_BATCH;
+    return unsubscribe_matching(event, subscription);
+}
+
+bool event_unsubscribe_ctx(Event* event, EventContextHandler handler, void* ctx)
+{
+    EventSubscription subscription = { 0 };
+    subscription.context_handler = handler;
+    subscription.ctx = ctx;
+    subscription.kind = EVENT_HANDLER_CONTEXT;
+    return unsubscribe_matching(event, subscription);
+}
+
+// Readers of a concurrent event whose snapshot could not be allocated.
+static EventSnapshot empty_snapshot;
+
+// Pins the handler list for the duration of a notify. In concurrent mode
+// this enters a read-side critical section (or takes write_lock when the
+// thread has no reader slot) and returns the snapshot to walk; *slot must be
+// passed back to notify_end(). A non-concurrent event returns NULL: its list
+// is read through notify_entry() on every step instead, and compaction waits
+// until the outermost notify has ended.
+static const EventSnapshot* notify_begin(Event* event, int* slot)
+{
+    EventSnapshot* snapshot;
+
+    if (!event->concurrent)
+    {
+        __atomic_add_fetch(&event->notifying, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    *slot = reader_enter();
+    if (*slot < 0)
     {
-        if (event->handlers[i] == handler)
+        // Out of reader slots: the lock keeps writers from freeing the
+        // snapshot under us.
+        pthread_mutex_lock(&event->write_lock);
+    }
+    snapshot = __atomic_load_n(&event->snapshot, __ATOMIC_SEQ_CST);
+    return snapshot ? snapshot : &empty_snapshot;
+}
+
+static void notify_end(Event* event, int slot)
+{
+    if (!event->concurrent)
+    {
+        if (__atomic_sub_fetch(&event->notifying, 1, __ATOMIC_RELAXED) == 0 && (event->unsorted || compact_due(event)))
         {
-            for(j = i; j < event->count - 1; j++)
+            compact(event);
+            if (event->unsorted)
             {
-                event->handlers[j] = event->handlers[j+1];
+                sort_by_priority(event);
             }
-            event->count--;
-            return true;
         }
+        return;
+    }
+    if (slot < 0)
+    {
+        pthread_mutex_unlock(&event->write_lock);
+    }
+    else
+    {
+        reader_exit(slot);
+    }
+}
+
+// A handler of a non-concurrent event may subscribe or unsubscribe on it,
+// which can move the array or append to it, so count and entries are re-read
+// after every call rather than cached for the whole notify.
+static inline size_t notify_count(const Event* event, const EventSnapshot* snapshot)
+{
+    return snapshot ? snapshot->count : event->count;
+}
+
+static inline const EventSubscription* notify_entry(const Event* event, const EventSnapshot* snapshot, size_t i)
+{
+    return snapshot ? &snapshot->handlers[i] : &event->handlers[i];
+}
+
+// Type tag from the EventHeader at the start of the payload; payloads too
+// short to carry one have type 0 and only reach unfiltered handlers.
+static inline uint32_t payload_type(const void* data, size_t length)
+{
+    EventHeader header = { 0 };
+    if (length >= sizeof(header))
+    {
+        memcpy(&header, data, sizeof(header));
     }
-    return false;
+    return header.type;
+}
+
+static inline bool filter_accepts(uint32_t filter_mask, uint32_t type)
+{
+    return filter_mask == 0 || (filter_mask & type) != 0;
 }
+
+static void notify_now(Event* event, const void* data, size_t length)
+{
+    const EventSnapshot* snapshot;
+    size_t i;
+    uint32_t type = payload_type(data, length);
+    int slot = 0;
+
+    snapshot = notify_begin(event, &slot);
+    for( i = 0; i < notify_count(event, snapshot); i++)
+    {
+        const EventSubscription* subscription = notify_entry(event, snapshot, i);
+        // Stats key, read before the entry can move under the handler.
+        EventHandler key = subscription->handler;
+
+        if (!filter_accepts(subscription->filter_mask, type))
+        {
+            continue;
+        }
+        EVENT_STATS_START(start);
+        switch (subscription_kind(subscription))
+        {
+            case EVENT_HANDLER_PLAIN:
+                subscription->handler (event, data, length);
+                break;
+
+            case EVENT_HANDLER_CONTEXT:
+                subscription->context_handler (event, data, length, subscription->ctx);
+                break;
+
+            case EVENT_HANDLER_BATCH:
+            {
+                EventRecord record = { data, length };
+                subscription->batch_handler (event, &record, 1);
+                break;
+            }
+
+            default:
+                continue;
+        }
+        EVENT_STATS_STOP(start, key, 1);
+    }
+    notify_end(event, slot);
+}
+
 void event_notify(Event* event, const void* data, size_t length)
 {
     // Write your implementation here.
-    int i;
-    for( i = 0; i < event->count; i++)
+    if (__atomic_load_n(&event->coalescer, __ATOMIC_ACQUIRE))
+    {
+        event_notify_keyed(event, 0, data, length);
+        return;
+    }
+    notify_now(event, data, length);
+}
+
+void event_notify_batch(Event* event, const EventRecord* records, size_t record_count)
+{
+    const EventSnapshot* snapshot;
+    size_t i, j;
+    int slot = 0;
+
+    if (record_count == 0)
+    {
+        return;
+    }
+
+    // Each handler gets the whole batch before the next handler runs, so a
+    // per-message handler walks the records while its code is hot.
+    snapshot = notify_begin(event, &slot);
+    for (i = 0; i < notify_count(event, snapshot); i++)
+    {
+        const EventSubscription* subscription = notify_entry(event, snapshot, i);
+        // Read before the first call: the entry may move while a handler runs.
+        uint32_t filter_mask = subscription->filter_mask;
+        EventHandler key = subscription->handler;
+        size_t calls = 0;
+
+        EVENT_STATS_START(start);
+        switch (subscription_kind(subscription))
+        {
+            case EVENT_HANDLER_BATCH:
+            {
+                EventBatchHandler handler = subscription->batch_handler;
+                size_t run_start = 0;
+
+                if (filter_mask == 0)
+                {
+                    handler (event, records, record_count);
+                    calls = 1;
+                    break;
+                }
+                // Filtered: each run of accepted records is passed as is,
+                // without copying them into a new array.
+                for (j = 0; j <= record_count; j++)
+                {
+                    if (j < record_count &&
+                        filter_accepts(filter_mask, payload_type(records[j].data, records[j].length)))
+                    {
+                        continue;
+                    }
+                    if (j > run_start)
+                    {
+                        handler (event, records + run_start, j - run_start);
+                        calls++;
+                    }
+                    run_start = j + 1;
+                }
+                break;
+            }
+
+            case EVENT_HANDLER_PLAIN:
+            {
+                EventHandler handler = subscription->handler;
+                for (j = 0; j < record_count; j++)
+                {
+                    if (filter_accepts(filter_mask, payload_type(records[j].data, records[j].length)))
+                    {
+                        handler (event, records[j].data, records[j].length);
+                        calls++;
+                    }
+                }
+                break;
+            }
+
+            case EVENT_HANDLER_CONTEXT:
+            {
+                EventContextHandler handler = subscription->context_handler;
+                void* ctx = subscription->ctx;
+                for (j = 0; j < record_count; j++)
+                {
+                    if (filter_accepts(filter_mask, payload_type(records[j].data, records[j].length)))
+                    {
+                        handler (event, records[j].data, records[j].length, ctx);
+                        calls++;
+                    }
+                }
+                break;
+            }
+
+            default:
+                continue;
+        }
+        EVENT_STATS_STOP(start, key, calls);
+    }
+    notify_end(event, slot);
+}
+
+// Coalescing mode. Each key has one entry holding the latest payload;
+// entries live in a dense array (indices never move) found through an
+// open-addressing index. pending lists the entries updated since the last
+// flush, in first-update order.
+typedef struct CoalesceEntry
+{
+    uint64_t key;
+    void* data;
+    size_t length;
+    size_t capacity;
+    bool pending;
+}CoalesceEntry;
+
+typedef struct CoalesceDelivery
+{
+    uint32_t entry;
+    void* data;
+    size_t length;
+    size_t capacity;
+}CoalesceDelivery;
+
+struct EventCoalescer
+{
+    pthread_mutex_t lock;              // entries, index, pending
+    pthread_mutex_t flush_lock;        // one flush at a time
+    CoalesceEntry* entries;
+    size_t entry_count;
+    size_t entry_capacity;
+    uint32_t* index;                   // entry + 1, 0 = empty
+    size_t index_size;
+    uint32_t* pending;
+    size_t pending_count;
+    CoalesceDelivery* deliveries;      // flush scratch, owned by flush_lock
+    size_t delivery_capacity;
+
+    unsigned long long interval_ns;
+    unsigned long long last_flush_ns;
+    unsigned long long received;
+    unsigned long long delivered;
+
+    bool has_timer;
+    bool stopping;
+    bool closing;                      // disable in progress: notifiers flush
+    pthread_t timer;
+    pthread_cond_t timer_cond;
+};
+
+static unsigned long long coalesce_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static size_t key_hash(uint64_t key, size_t size)
+{
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (size - 1);
+}
+
+static bool coalesce_reserve(EventCoalescer* c)
+{
+    size_t i;
+
+    if (c->entry_count == c->entry_capacity)
+    {
+        size_t new_capacity = c->entry_capacity ? c->entry_capacity * 2 : INIT_CAPACITY;
+        CoalesceEntry* entries = realloc(c->entries, new_capacity * sizeof(*entries));
+        uint32_t* pending;
+
+        if (entries == NULL)
+        {
+            return false;
+        }
+        c->entries = entries;
+        pending = realloc(c->pending, new_capacity * sizeof(*pending));
+        if (pending == NULL)
+        {
+            return false;
+        }
+        c->pending = pending;
+        c->entry_capacity = new_capacity;
+    }
+
+    if ((c->entry_count + 1) * 2 > c->index_size)
+    {
+        size_t new_size = c->index_size ? c->index_size * 2 : INIT_CAPACITY * 2;
+        uint32_t* index = calloc(new_size, sizeof(*index));
+
+        if (index == NULL)
+        {
+            return false;
+        }
+        for (i = 0; i < c->entry_count; i++)
+        {
+            size_t h = key_hash(c->entries[i].key, new_size);
+            while (index[h])
+            {
+                h = (h + 1) & (new_size - 1);
+            }
+            index[h] = (uint32_t)i + 1;
+        }
+        free(c->index);
+        c->index = index;
+        c->index_size = new_size;
+    }
+    return true;
+}
+
+static CoalesceEntry* coalesce_find(EventCoalescer* c, uint64_t key)
+{
+    size_t h;
+
+    if (c->index_size)
+    {
+        h = key_hash(key, c->index_size);
+        while (c->index[h])
+        {
+            CoalesceEntry* entry = &c->entries[c->index[h] - 1];
+            if (entry->key == key)
+            {
+                return entry;
+            }
+            h = (h + 1) & (c->index_size - 1);
+        }
+    }
+
+    if (!coalesce_reserve(c))
+    {
+        return NULL;
+    }
+    h = key_hash(key, c->index_size);
+    while (c->index[h])
+    {
+        h = (h + 1) & (c->index_size - 1);
+    }
+    c->index[h] = (uint32_t)c->entry_count + 1;
+    memset(&c->entries[c->entry_count], 0, sizeof(c->entries[0]));
+    c->entries[c->entry_count].key = key;
+    return &c->entries[c->entry_count++];
+}
+
+// Notifiers hold a read-side section (or coalesce_fallback_lock when out
+// of reader slots) while they use event->coalescer, so that disable can
+// unpublish it and wait until no thread still does before freeing it.
+static pthread_once_t coalesce_fallback_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t coalesce_fallback_lock;
+
+static void coalesce_fallback_init(void)
+{
+    pthread_mutexattr_t attr;
+
+    // Recursive: a flush runs handlers, which may notify coalesced events.
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&coalesce_fallback_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+static EventCoalescer* coalescer_enter(Event* event, int* slot)
+{
+    *slot = reader_enter();
+    if (*slot < 0)
+    {
+        pthread_once(&coalesce_fallback_once, coalesce_fallback_init);
+        pthread_mutex_lock(&coalesce_fallback_lock);
+    }
+    return __atomic_load_n(&event->coalescer, __ATOMIC_SEQ_CST);
+}
+
+static void coalescer_exit(int slot)
+{
+    if (slot < 0)
+    {
+        pthread_mutex_unlock(&coalesce_fallback_lock);
+    }
+    else
+    {
+        reader_exit(slot);
+    }
+}
+
+// Coalescer this thread is flushing, so a handler that notifies the same
+// event (or calls event_flush()) does not wait on flush_lock for itself.
+static __thread EventCoalescer* flushing;
+
+static size_t coalesce_flush(Event* event, EventCoalescer* c)
+{
+    EventCoalescer* outer = flushing;
+    size_t i, count;
+
+    if (c == flushing)
+    {
+        // Called from one of our own handlers: whatever it queued stays
+        // pending for the next flush.
+        return 0;
+    }
+
+    pthread_mutex_lock(&c->flush_lock);
+    flushing = c;
+    pthread_mutex_lock(&c->lock);
+    count = c->pending_count;
+    if (count > c->delivery_capacity)
+    {
+        CoalesceDelivery* grown = realloc(c->deliveries, count * sizeof(*grown));
+        if (grown == NULL)
+        {
+            pthread_mutex_unlock(&c->lock);
+            flushing = outer;
+            pthread_mutex_unlock(&c->flush_lock);
+            return 0;
+        }
+        c->deliveries = grown;
+        c->delivery_capacity = count;
+    }
+    // Take the payload buffers so producers can keep coalescing into fresh
+    // ones while handlers run without the lock.
+    for (i = 0; i < count; i++)
+    {
+        CoalesceEntry* entry = &c->entries[c->pending[i]];
+        c->deliveries[i].entry = c->pending[i];
+        c->deliveries[i].data = entry->data;
+        c->deliveries[i].length = entry->length;
+        c->deliveries[i].capacity = entry->capacity;
+        entry->data = NULL;
+        entry->capacity = 0;
+        entry->pending = false;
+    }
+    c->pending_count = 0;
+    c->last_flush_ns = coalesce_now_ns();
+    pthread_mutex_unlock(&c->lock);
+
+    for (i = 0; i < count; i++)
+    {
+        notify_now(event, c->deliveries[i].data, c->deliveries[i].length);
+    }
+
+    // Hand the buffers back to entries that did not get a new one meanwhile.
+    pthread_mutex_lock(&c->lock);
+    for (i = 0; i < count; i++)
+    {
+        CoalesceEntry* entry = &c->entries[c->deliveries[i].entry];
+        if (entry->data == NULL)
+        {
+            entry->data = c->deliveries[i].data;
+            entry->capacity = c->deliveries[i].capacity;
+        }
+        else
+        {
+            free(c->deliveries[i].data);
+        }
+    }
+    c->delivered += count;
+    pthread_mutex_unlock(&c->lock);
+    flushing = outer;
+    pthread_mutex_unlock(&c->flush_lock);
+    return count;
+}
+
+size_t event_flush(Event* event)
+{
+    size_t count = 0;
+    int slot;
+    EventCoalescer* c = coalescer_enter(event, &slot);
+
+    if (c)
+    {
+        count = coalesce_flush(event, c);
+    }
+    coalescer_exit(slot);
+    return count;
+}
+
+void event_notify_keyed(Event* event, uint64_t key, const void* data, size_t length)
+{
+    int slot;
+    EventCoalescer* c = coalescer_enter(event, &slot);
+    CoalesceEntry* entry;
+    bool due = false;
+
+    if (c == NULL)
+    {
+        coalescer_exit(slot);
+        notify_now(event, data, length);
+        return;
+    }
+
+    pthread_mutex_lock(&c->lock);
+    c->received++;
+    entry = coalesce_find(c, key);
+    if (entry && length > entry->capacity)
+    {
+        void* grown = realloc(entry->data, length);
+        if (grown == NULL)
+        {
+            entry = NULL;
+        }
+        else
+        {
+            entry->data = grown;
+            entry->capacity = length;
+        }
+    }
+    if (entry)
+    {
+        if (length > 0)
+        {
+            memcpy(entry->data, data, length);
+        }
+        entry->length = length;
+        if (!entry->pending)
+        {
+            entry->pending = true;
+            c->pending[c->pending_count++] = (uint32_t)(entry - c->entries);
+        }
+    }
+    if (c->closing)
+    {
+        // Disable has done its last flush; deliver this update ourselves.
+        due = true;
+    }
+    else if (!c->has_timer && c->interval_ns)
     {
-        event->handlers[i] (event, data, length);
+        due = coalesce_now_ns() - c->last_flush_ns >= c->interval_ns;
     }
+    pthread_mutex_unlock(&c->lock);
+
+    if (entry == NULL)
+    {
+        // Out of memory: deliver rather than lose the update.
+        notify_now(event, data, length);
+    }
+    else if (due)
+    {
+        coalesce_flush(event, c);
+    }
+    coalescer_exit(slot);
 }
 
+// Disable joins the timer before it frees the coalescer, so the timer uses
+// it without entering a read-side section.
+static void* coalesce_timer(void* arg)
+{
+    Event* event = arg;
+    EventCoalescer* c = __atomic_load_n(&event->coalescer, __ATOMIC_ACQUIRE);
+
+    pthread_mutex_lock(&c->lock);
+    while (!c->stopping)
+    {
+        unsigned long long wake_ns;
+        struct timespec deadline;
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        wake_ns = (unsigned long long)deadline.tv_sec * 1000000000ULL + deadline.tv_nsec + c->interval_ns;
+        deadline.tv_sec = wake_ns / 1000000000ULL;
+        deadline.tv_nsec = wake_ns % 1000000000ULL;
+        pthread_cond_timedwait(&c->timer_cond, &c->lock, &deadline);
+        if (c->stopping)
+        {
+            break;
+        }
+        pthread_mutex_unlock(&c->lock);
+        coalesce_flush(event, c);
+        pthread_mutex_lock(&c->lock);
+    }
+    pthread_mutex_unlock(&c->lock);
+    return NULL;
+}
+
+bool event_enable_coalescing(Event* event, unsigned int interval_ms, bool timer_thread)
+{
+    EventCoalescer* c;
+
+    if (event->coalescer)
+    {
+        return false;
+    }
+    c = calloc(1, sizeof(*c));
+    if (c == NULL)
+    {
+        return false;
+    }
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_mutex_init(&c->flush_lock, NULL);
+    pthread_cond_init(&c->timer_cond, NULL);
+    c->interval_ns = (unsigned long long)interval_ms * 1000000ULL;
+    c->last_flush_ns = coalesce_now_ns();
+    // Set before c is published: notifiers read it under c->lock only.
+    c->has_timer = timer_thread && interval_ms > 0;
+    __atomic_store_n(&event->coalescer, c, __ATOMIC_RELEASE);
+
+    if (c->has_timer && pthread_create(&c->timer, NULL, coalesce_timer, event) != 0)
+    {
+        pthread_mutex_lock(&c->lock);
+        c->has_timer = false;
+        pthread_mutex_unlock(&c->lock);
+        event_disable_coalescing(event);
+        return false;
+    }
+    return true;
+}
+
+void event_disable_coalescing(Event* event)
+{
+    EventCoalescer* c = event->coalescer;
+    size_t i;
+
+    if (c == NULL)
+    {
+        return;
+    }
+    pthread_mutex_lock(&c->lock);
+    c->stopping = true;
+    c->closing = true;
+    pthread_cond_signal(&c->timer_cond);
+    pthread_mutex_unlock(&c->lock);
+    if (c->has_timer)
+    {
+        pthread_join(c->timer, NULL);
+    }
+
+    // Updates queued from here on are flushed by their own notifier, so
+    // pending keys are still delivered in order.
+    coalesce_flush(event, c);
+    __atomic_store_n(&event->coalescer, NULL, __ATOMIC_SEQ_CST);
+
+    // Wait out notifiers that loaded c before it was unpublished.
+    wait_for_readers();
+    pthread_once(&coalesce_fallback_once, coalesce_fallback_init);
+    pthread_mutex_lock(&coalesce_fallback_lock);
+    pthread_mutex_unlock(&coalesce_fallback_lock);
+    // Left behind only by a handler that re-entered a flush, or by a flush
+    // that ran out of memory.
+    coalesce_flush(event, c);
+
+    for (i = 0; i < c->entry_count; i++)
+    {
+        free(c->entries[i].data);
+    }
+    free(c->entries);
+    free(c->index);
+    free(c->pending);
+    free(c->deliveries);
+    pthread_cond_destroy(&c->timer_cond);
+    pthread_mutex_destroy(&c->flush_lock);
+    pthread_mutex_destroy(&c->lock);
+    free(c);
+}
+
+void event_get_coalesce_stats(Event* event, EventCoalesceStats* stats)
+{
+    int slot;
+    EventCoalescer* c = coalescer_enter(event, &slot);
+
+    memset(stats, 0, sizeof(*stats));
+    if (c)
+    {
+        pthread_mutex_lock(&c->lock);
+        stats->received = c->received;
+        stats->delivered = c->delivered;
+        stats->pending = c->pending_count;
+        stats->keys = c->entry_count;
+        pthread_mutex_unlock(&c->lock);
+    }
+    coalescer_exit(slot);
+}
@@ -0,0 +1,357 @@
+#include "event_shm.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+// Every record starts with this header and is padded to 8 bytes. A pad
+// record fills the tail of the ring when the next record would not fit
+// contiguously, so payloads are never split and can be read in place.
+typedef struct ShmRecord
+{
+    uint32_t length;
+    uint32_t flags;
+}ShmRecord;
+
+#define RECORD_PAD    1u
+
+static size_t record_size(size_t length)
+{
+    return sizeof(ShmRecord) + ((length + 7) & ~(size_t)7);
+}
+
+// Shared (not FUTEX_PRIVATE) futex ops, since waiter and waker live in
+// different processes.
+static int futex_wait(uint32_t* addr, uint32_t expected, const struct timespec* timeout)
+{
+    return (int)syscall(SYS_futex, addr, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+static void futex_wake_all(uint32_t* addr)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+static bool map_segment(EventShm* shm, int fd, size_t map_size)
+{
+    void* memory = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+        return false;
+    }
+    shm->header = memory;
+    shm->data = (unsigned char*)memory + sizeof(EventShmHeader);
+    shm->map_size = map_size;
+    return true;
+}
+
+bool event_shm_create(EventShm* shm, const char* name, size_t data_size)
+{
+    size_t size = 4096;
+    int fd;
+
+    while (size < data_size)
+    {
+        size <<= 1;
+    }
+
+    memset(shm, 0, sizeof(*shm));
+    shm->consumer = -1;
+    // Never reuse an existing object: truncating one that consumers still
+    // have mapped would make their next access fault with SIGBUS.
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        return false;
+    }
+    if (ftruncate(fd, sizeof(EventShmHeader) + size) < 0)
+    {
+        int saved = errno;
+        close(fd);
+        shm_unlink(name);
+        errno = saved;
+        return false;
+    }
+    if (!map_segment(shm, fd, sizeof(EventShmHeader) + size))
+    {
+        int saved = errno;
+        shm_unlink(name);
+        errno = saved;
+        return false;
+    }
+
+    // ftruncate zero-filled the segment; publish the magic last so an
+    // attaching consumer never sees a half-initialized header.
+    shm->header->version = EVENT_SHM_VERSION;
+    shm->header->data_size = size;
+    __atomic_store_n(&shm->header->magic, EVENT_SHM_MAGIC, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool event_shm_open(EventShm* shm, const char* name)
+{
+    EventShmHeader* h;
+    struct stat st;
+    int fd, i;
+
+    memset(shm, 0, sizeof(*shm));
+    shm->consumer = -1;
+    fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(EventShmHeader))
+    {
+        close(fd);
+        return false;
+    }
+    if (!map_segment(shm, fd, (size_t)st.st_size))
+    {
+        return false;
+    }
+
+    h = shm->header;
+    if (__atomic_load_n(&h->magic, __ATOMIC_ACQUIRE) != EVENT_SHM_MAGIC ||
+        h->version != EVENT_SHM_VERSION ||
+        sizeof(EventShmHeader) + h->data_size != shm->map_size)
+    {
+        event_shm_close(shm);
+        return false;
+    }
+
+    for (i = 0; i < EVENT_SHM_MAX_CONSUMERS; i++)
+    {
+        uint32_t expected = 0;
+        if (__atomic_compare_exchange_n(&h->consumers[i].active, &expected, 1, false,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        {
+            // Once active is visible the producer respects read_pos; the
+            // stale value left by a previous consumer is only ever behind.
+            // pid is set last and marks the cursor as positioned.
+            __atomic_store_n(&h->consumers[i].read_pos,
+                             __atomic_load_n(&h->write_pos, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+            __atomic_store_n(&h->consumers[i].pid, getpid(), __ATOMIC_RELEASE);
+            shm->consumer = i;
+            return true;
+        }
+    }
+    event_shm_close(shm);
+    return false;
+}
+
+void event_shm_close(EventShm* shm)
+{
+    if (shm->header == NULL)
+    {
+        return;
+    }
+    if (shm->consumer >= 0)
+    {
+        __atomic_store_n(&shm->header->consumers[shm->consumer].pid, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&shm->header->consumers[shm->consumer].active, 0, __ATOMIC_RELEASE);
+    }
+    munmap(shm->header, shm->map_size);
+    shm->header = NULL;
+    shm->data = NULL;
+    shm->consumer = -1;
+}
+
+int event_shm_unlink(const char* name)
+{
+    return shm_unlink(name);
+}
+
+static bool has_space(EventShmHeader* h, uint64_t pos, uint64_t total)
+{
+    int i;
+    for (i = 0; i < EVENT_SHM_MAX_CONSUMERS; i++)
+    {
+        if (__atomic_load_n(&h->consumers[i].active, __ATOMIC_SEQ_CST))
+        {
+            uint64_t read_pos = __atomic_load_n(&h->consumers[i].read_pos, __ATOMIC_ACQUIRE);
+            if (pos + total - read_pos > h->data_size)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// A consumer that died without closing would stall the producer forever.
+static void reap_dead_consumers(EventShmHeader* h)
+{
+    int i;
+    for (i = 0; i < EVENT_SHM_MAX_CONSUMERS; i++)
+    {
+        int32_t pid = __atomic_load_n(&h->consumers[i].pid, __ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&h->consumers[i].active, __ATOMIC_ACQUIRE) && pid > 0 &&
+            kill(pid, 0) < 0 && errno == ESRCH)
+        {
+            __atomic_store_n(&h->consumers[i].active, 0, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+void* event_shm_reserve(EventShm* shm, size_t length)
+{
+    EventShmHeader* h = shm->header;
+    uint64_t size = h->data_size;
+    uint64_t pos = h->write_pos;
+    uint64_t offset = pos & (size - 1);
+    uint64_t contig = size - offset;
+    size_t need = record_size(length);
+    uint64_t total = contig < need ? contig + need : need;
+    ShmRecord* record;
+
+    if (need > size || length > UINT32_MAX)
+    {
+        return NULL;
+    }
+    if (!has_space(h, pos, total))
+    {
+        reap_dead_consumers(h);
+        if (!has_space(h, pos, total))
+        {
+            return NULL;
+        }
+    }
+
+    if (contig < need)
+    {
+        // Becomes visible together with the record at commit time.
+        record = (ShmRecord*)(shm->data + offset);
+        record->length = (uint32_t)(contig - sizeof(ShmRecord));
+        record->flags = RECORD_PAD;
+        pos += contig;
+        offset = 0;
+    }
+
+    record = (ShmRecord*)(shm->data + offset);
+    record->length = (uint32_t)length;
+    record->flags = 0;
+    shm->reserve_pos = pos;
+    return record + 1;
+}
+
+void event_shm_commit(EventShm* shm, size_t length)
+{
+    EventShmHeader* h = shm->header;
+
+    __atomic_store_n(&h->write_pos, shm->reserve_pos + record_size(length), __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&h->wake_seq, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&h->waiters, __ATOMIC_SEQ_CST) > 0)
+    {
+        futex_wake_all(&h->wake_seq);
+    }
+}
+
+bool event_shm_publish(EventShm* shm, const void* data, size_t length)
+{
+    void* payload = event_shm_reserve(shm, length);
+    if (payload == NULL)
+    {
+        return false;
+    }
+    memcpy(payload, data, length);
+    event_shm_commit(shm, length);
+    return true;
+}
+
+static unsigned long long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+
+// Sleeps on wake_seq until write_pos moves past read_pos. waiters is raised
+// before write_pos is re-checked, so a producer either sees the waiter or
+// the waiter sees its record.
+static bool wait_for_data(EventShmHeader* h, uint64_t read_pos, int timeout_ms)
+{
+    unsigned long long deadline = now_ms() + (timeout_ms > 0 ? timeout_ms : 0);
+
+    for (;;)
+    {
+        uint32_t seq = __atomic_load_n(&h->wake_seq, __ATOMIC_SEQ_CST);
+        struct timespec ts, *tsp = NULL;
+        bool ready;
+
+        __atomic_add_fetch(&h->waiters, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&h->write_pos, __ATOMIC_SEQ_CST) == read_pos)
+        {
+            if (timeout_ms >= 0)
+            {
+                unsigned long long now = now_ms();
+                unsigned long long left = deadline > now ? deadline - now : 0;
+                ts.tv_sec = left / 1000;
+                ts.tv_nsec = (left % 1000) * 1000000;
+                tsp = &ts;
+            }
+            futex_wait(&h->wake_seq, seq, tsp);
+        }
+        __atomic_sub_fetch(&h->waiters, 1, __ATOMIC_SEQ_CST);
+
+        ready = __atomic_load_n(&h->write_pos, __ATOMIC_ACQUIRE) != read_pos;
+        if (ready || (timeout_ms >= 0 && now_ms() >= deadline))
+        {
+            return ready;
+        }
+    }
+}
+
+size_t event_shm_poll(EventShm* shm, Event* event, int timeout_ms)
+{
+    EventShmHeader* h = shm->header;
+    EventShmConsumer* self;
+    uint64_t mask, read_pos, write_pos;
+    size_t delivered = 0;
+
+    if (shm->consumer < 0)
+    {
+        return 0;
+    }
+    self = &h->consumers[shm->consumer];
+    mask = h->data_size - 1;
+    read_pos = self->read_pos;
+
+    write_pos = __atomic_load_n(&h->write_pos, __ATOMIC_ACQUIRE);
+    if (write_pos == read_pos)
+    {
+        if (timeout_ms == 0 || !wait_for_data(h, read_pos, timeout_ms))
+        {
+            return 0;
+        }
+        write_pos = __atomic_load_n(&h->write_pos, __ATOMIC_ACQUIRE);
+    }
+
+    while (read_pos != write_pos)
+    {
+        const ShmRecord* record = (const ShmRecord*)(shm->data + (read_pos & mask));
+
+        if (record->flags & RECORD_PAD)
+        {
+            read_pos += sizeof(ShmRecord) + record->length;
+        }
+        else
+        {
+            event_notify(event, record + 1, record->length);
+            read_pos += record_size(record->length);
+            delivered++;
+        }
+        // Handing space back record by record lets the producer refill
+        // while this batch is still being dispatched.
+        __atomic_store_n(&self->read_pos, read_pos, __ATOMIC_RELEASE);
+    }
+    return delivered;
+}
@@ -0,0 +1,232 @@
+#include "event_stats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// One table per recording thread, allocated on the thread's first record
+// and linked into a global list that only snapshots walk. Tables are never
+// freed, so counters of exited threads stay in the totals.
+typedef struct StatsTable
+{
+    struct StatsTable* next;
+    EventHandlerStats entries[EVENT_STATS_TABLE_SIZE];
+    EventHandlerStats overflow;
+}StatsTable;
+
+static pthread_mutex_t tables_lock = PTHREAD_MUTEX_INITIALIZER;
+static StatsTable* tables;
+
+#ifdef EVENT_INSTRUMENT
+
+static __thread StatsTable* local_table;
+
+uint64_t event_stats_now(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static StatsTable* table_create(void)
+{
+    StatsTable* table = aligned_alloc(64, (sizeof(StatsTable) + 63) & ~(size_t)63);
+    if (table == NULL)
+    {
+        return NULL;
+    }
+    memset(table, 0, sizeof(*table));
+
+    pthread_mutex_lock(&tables_lock);
+    table->next = tables;
+    __atomic_store_n(&tables, table, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&tables_lock);
+    return table;
+}
+
+static unsigned int bucket_of(uint64_t cost)
+{
+    unsigned int bucket = cost ? 64 - __builtin_clzll(cost) : 0;
+    return bucket < EVENT_STATS_BUCKETS ? bucket : EVENT_STATS_BUCKETS - 1;
+}
+
+// Only the owning thread writes its table; relaxed stores (not RMWs) keep
+// the values untorn for a concurrent snapshot.
+static void bump(unsigned long long* counter, unsigned long long delta)
+{
+    __atomic_store_n(counter, *counter + delta, __ATOMIC_RELAXED);
+}
+
+void event_stats_record(const void* handler, unsigned long long calls, uint64_t cost)
+{
+    StatsTable* table = local_table;
+    EventHandlerStats* entry = NULL;
+    size_t i, probe;
+
+    if (table == NULL)
+    {
+        table = local_table = table_create();
+        if (table == NULL)
+        {
+            return;
+        }
+    }
+
+    i = ((uintptr_t)handler >> 4) * 0x9E3779B97F4A7C15ULL >> 56;
+    for (probe = 0; probe < EVENT_STATS_TABLE_SIZE; probe++)
+    {
+        EventHandlerStats* candidate = &table->entries[(i + probe) % EVENT_STATS_TABLE_SIZE];
+        if (candidate->handler == handler)
+        {
+            entry = candidate;
+            break;
+        }
+        if (candidate->handler == NULL)
+        {
+            __atomic_store_n(&candidate->handler, handler, __ATOMIC_RELEASE);
+            entry = candidate;
+            break;
+        }
+    }
+    if (entry == NULL)
+    {
+        entry = &table->overflow;
+    }
+
+    bump(&entry->calls, calls);
+    bump(&entry->cost, cost);
+    bump(&entry->histogram[bucket_of(cost)], 1);
+}
+
+#endif // EVENT_INSTRUMENT
+
+static void merge(EventHandlerStats* into, const EventHandlerStats* from)
+{
+    int b;
+    into->calls += __atomic_load_n(&from->calls, __ATOMIC_RELAXED);
+    into->cost += __atomic_load_n(&from->cost, __ATOMIC_RELAXED);
+    for (b = 0; b < EVENT_STATS_BUCKETS; b++)
+    {
+        into->histogram[b] += __atomic_load_n(&from->histogram[b], __ATOMIC_RELAXED);
+    }
+}
+
+static int by_cost_desc(const void* a, const void* b)
+{
+    const EventHandlerStats* x = a;
+    const EventHandlerStats* y = b;
+    return x->cost < y->cost ? 1 : x->cost > y->cost ? -1 : 0;
+}
+
+// Merges into a scratch array with room for every distinct handler, so the
+// ranking is right even when the caller asks for fewer entries.
+size_t event_stats_snapshot(EventHandlerStats* out, size_t max)
+{
+    EventHandlerStats* merged = NULL;
+    size_t count = 0, capacity = 0, i, j;
+    StatsTable* table;
+
+    pthread_mutex_lock(&tables_lock);
+    for (table = tables; table; table = table->next)
+    {
+        for (i = 0; i <= EVENT_STATS_TABLE_SIZE; i++)
+        {
+            const EventHandlerStats* entry = i < EVENT_STATS_TABLE_SIZE ? &table->entries[i] : &table->overflow;
+            const void* handler = __atomic_load_n(&entry->handler, __ATOMIC_ACQUIRE);
+
+            if (handler == NULL && entry != &table->overflow)
+            {
+                continue;
+            }
+            if (entry == &table->overflow && __atomic_load_n(&entry->calls, __ATOMIC_RELAXED) == 0)
+            {
+                continue;
+            }
+            for (j = 0; j < count && merged[j].handler != handler; j++)
+            {
+            }
+            if (j == count)
+            {
+                if (count == capacity)
+                {
+                    size_t new_capacity = capacity ? capacity * 2 : 64;
+                    EventHandlerStats* grown = realloc(merged, new_capacity * sizeof(*grown));
+                    if (grown == NULL)
+                    {
+                        continue;
+                    }
+                    merged = grown;
+                    capacity = new_capacity;
+                }
+                memset(&merged[count], 0, sizeof(merged[count]));
+                merged[count++].handler = handler;
+            }
+            merge(&merged[j], entry);
+        }
+    }
+    pthread_mutex_unlock(&tables_lock);
+
+    if (count > 1)
+    {
+        qsort(merged, count, sizeof(*merged), by_cost_desc);
+    }
+    if (out && count > 0)
+    {
+        memcpy(out, merged, (count < max ? count : max) * sizeof(*out));
+    }
+    free(merged);
+    return count;
+}
+
+// Upper bound of the bucket holding the given fraction of calls.
+static unsigned long long percentile(const EventHandlerStats* stats, double fraction)
+{
+    unsigned long long total = 0, seen = 0;
+    int b;
+
+    for (b = 0; b < EVENT_STATS_BUCKETS; b++)
+    {
+        total += stats->histogram[b];
+    }
+    for (b = 0; b < EVENT_STATS_BUCKETS; b++)
+    {
+        seen += stats->histogram[b];
+        if (total && seen >= fraction * total)
+        {
+            return 1ULL << b;
+        }
+    }
+    return 0;
+}
+
+void event_stats_dump(FILE* stream)
+{
+    size_t count = event_stats_snapshot(NULL, 0), seen, i;
+    EventHandlerStats* stats = malloc((count ? count : 1) * sizeof(*stats));
+
+    if (stats == NULL)
+    {
+        return;
+    }
+    // Handlers first seen between the two snapshots are left out.
+    seen = event_stats_snapshot(stats, count);
+    count = seen < count ? seen : count;
+
+    fprintf(stream, "%-18s %12s %16s %10s %10s %10s\n",
+            "handler", "calls", "total cost", "avg", "p50<", "p99<");
+    for (i = 0; i < count; i++)
+    {
+        fprintf(stream, "%-18p %12llu %16llu %10.1f %10llu %10llu\n",
+                stats[i].handler, stats[i].calls, stats[i].cost,
+                stats[i].calls ? (double)stats[i].cost / stats[i].calls : 0.0,
+                percentile(&stats[i], 0.50), percentile(&stats[i], 0.99));
+    }
+    free(stats);
+}
@@ -0,0 +1,107 @@
+/*
+ * Benchmark for event_notify_batch() against a per-message event_notify()
+ * loop, at batch sizes 1, 16, 256 and 4096.
+ *
+ * Each configuration delivers the same number of records to SUBSCRIBERS
+ * handlers, once with plain handlers and once with batch-aware handlers.
+ *
+ * Build: gcc -O2 -pthread Event_notifier.c bench_batch_notify.c -o bench_batch_notify
+ * Usage: ./bench_batch_notify [records_total]
+ */
+
+#include "event_notifier.h"
+#include <stdio.h>
+#include <time.h>
+
+#define SUBSCRIBERS    8
+
+static volatile size_t sink;
+
+static void plain_handler(const Event* event, const void* data, size_t length)
+{
+    (void)event; (void)data;
+    sink += length;
+}
+
+static void batch_handler(const Event* event, const EventRecord* records, size_t count)
+{
+    size_t i, total = 0;
+    (void)event;
+    for (i = 0; i < count; i++)
+    {
+        total += records[i].length;
+    }
+    sink += total;
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double run(Event* event, const EventRecord* records, size_t batch,
+                  size_t total, bool batched)
+{
+    size_t done, i;
+    double start = now_sec();
+
+    for (done = 0; done < total; done += batch)
+    {
+        if (batched)
+        {
+            event_notify_batch(event, records, batch);
+        }
+        else
+        {
+            for (i = 0; i < batch; i++)
+            {
+                event_notify(event, records[i].data, records[i].length);
+            }
+        }
+    }
+    return (now_sec() - start) * 1e9 / total;
+}
+
+int main(int argc, char* argv[])
+{
+    static const size_t batch_sizes[] = { 1, 16, 256, 4096 };
+    static unsigned char payloads[4096][32];
+    static EventRecord records[4096];
+    size_t total = argc > 1 ? strtoull(argv[1], NULL, 10) : 8u << 20;
+    size_t b, i;
+    Event plain, batch;
+
+    for (i = 0; i < 4096; i++)
+    {
+        records[i].data = payloads[i];
+        records[i].length = 1 + i % 32;
+    }
+
+    event_initialize(&plain);
+    event_initialize(&batch);
+    for (i = 0; i < SUBSCRIBERS; i++)
+    {
+        event_subscribe(&plain, plain_handler);
+        event_subscribe_batch(&batch, batch_handler);
+    }
+
+    printf("ns per record, %d subscribers\n", SUBSCRIBERS);
+    printf("%-7s %14s %14s %14s %14s\n", "batch",
+           "plain/loop", "plain/batch", "batchh/loop", "batchh/batch");
+    for (b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++)
+    {
+        size_t n = batch_sizes[b];
+        size_t rounds = total / n ? total / n : 1;
+        printf("%-7zu %14.2f %14.2f %14.2f %14.2f\n", n,
+               run(&plain, records, n, rounds * n, false),
+               run(&plain, records, n, rounds * n, true),
+               run(&batch, records, n, rounds * n, false),
+               run(&batch, records, n, rounds * n, true));
+    }
+
+    event_deinitialize(&plain);
+    event_deinitialize(&batch);
+    return 0;
+}
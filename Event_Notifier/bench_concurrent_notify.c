@@ -0,0 +1,126 @@
+/*
+ * Stress benchmark for concurrent-mode event_notify().
+ *
+ * N notifier threads call event_notify() in a tight loop while one churn
+ * thread keeps subscribing and unsubscribing a handler, so every run also
+ * exercises snapshot publication and reclamation. Reports total notify
+ * throughput for 1, 2, 4 ... max_threads notifiers.
+ *
+ * Build: gcc -O2 -pthread Event_notifier.c bench_concurrent_notify.c -o bench_concurrent_notify
+ * Usage: ./bench_concurrent_notify [max_threads] [notifies_per_thread]
+ */
+
+#include "event_notifier.h"
+#include <stdio.h>
+#include <time.h>
+
+#define SUBSCRIBERS    8
+
+static Event event;
+static volatile int churn_running;
+static __thread unsigned long long calls;
+
+static void handler(const Event* e, const void* data, size_t length)
+{
+    (void)e; (void)data; (void)length;
+    calls++;
+}
+
+static void churn_handler(const Event* e, const void* data, size_t length)
+{
+    (void)e; (void)data; (void)length;
+    calls++;
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+typedef struct WorkerArg
+{
+    unsigned long long iterations;
+    unsigned long long calls;
+}WorkerArg;
+
+static void* notifier_thread(void* arg)
+{
+    WorkerArg* worker = arg;
+    unsigned long long i;
+    int payload = 42;
+
+    for (i = 0; i < worker->iterations; i++)
+    {
+        event_notify(&event, &payload, sizeof(payload));
+    }
+    worker->calls = calls;
+    return NULL;
+}
+
+static void* churn_thread(void* arg)
+{
+    unsigned long long* publishes = arg;
+    while (__atomic_load_n(&churn_running, __ATOMIC_RELAXED))
+    {
+        EventHandle handle = event_subscribe(&event, churn_handler);
+        event_unsubscribe_handle(&event, handle);
+        *publishes += 2;
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+    int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+    unsigned long long iterations = argc > 2 ? strtoull(argv[2], NULL, 10) : 2000000ULL;
+    int threads, i;
+
+    if (max_threads < 1 || max_threads > EVENT_MAX_READERS)
+    {
+        max_threads = EVENT_MAX_READERS;
+    }
+    printf("%-8s %14s %14s %12s\n", "threads", "notify/s", "handler/s", "publishes");
+
+    for (threads = 1; threads <= max_threads; threads *= 2)
+    {
+        pthread_t tid[EVENT_MAX_READERS];
+        WorkerArg args[EVENT_MAX_READERS];
+        pthread_t churn;
+        unsigned long long publishes = 0, total_calls = 0;
+        double start, elapsed;
+
+        event_initialize_concurrent(&event);
+        for (i = 0; i < SUBSCRIBERS; i++)
+        {
+            event_subscribe(&event, handler);
+        }
+
+        churn_running = 1;
+        pthread_create(&churn, NULL, churn_thread, &publishes);
+
+        start = now_sec();
+        for (i = 0; i < threads; i++)
+        {
+            args[i].iterations = iterations;
+            args[i].calls = 0;
+            pthread_create(&tid[i], NULL, notifier_thread, &args[i]);
+        }
+        for (i = 0; i < threads; i++)
+        {
+            pthread_join(tid[i], NULL);
+            total_calls += args[i].calls;
+        }
+        elapsed = now_sec() - start;
+
+        __atomic_store_n(&churn_running, 0, __ATOMIC_RELAXED);
+        pthread_join(churn, NULL);
+
+        printf("%-8d %14.0f %14.0f %12llu\n", threads,
+               threads * iterations / elapsed, total_calls / elapsed, publishes);
+
+        event_deinitialize(&event);
+    }
+    return 0;
+}
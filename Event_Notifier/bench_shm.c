@@ -0,0 +1,210 @@
+/*
+ * Two-process benchmark for the shared-memory Event transport.
+ *
+ * The parent creates the segment and publishes; a forked child attaches,
+ * subscribes a handler to a local Event and drains the ring with
+ * event_shm_poll(). Every payload carries its CLOCK_MONOTONIC send time,
+ * so the child measures one-way latency directly.
+ *
+ *  throughput  the producer publishes as fast as the ring allows
+ *  latency     the producer publishes one message every 20 microseconds
+ *
+ * Build: gcc -O2 -pthread Event_notifier.c Event_shm.c bench_shm.c -o bench_shm
+ * Usage: ./bench_shm [messages] [payload_bytes]
+ */
+
+#include "event_shm.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define SEGMENT_NAME    "/event_shm_bench"
+#define RING_BYTES      (4u << 20)
+
+typedef struct BenchPayload
+{
+    EventHeader header;
+    uint32_t last;
+    unsigned long long sent_ns;
+}BenchPayload;
+
+typedef struct ConsumerState
+{
+    unsigned long long* latencies;
+    size_t count;
+    size_t capacity;
+    bool done;
+}ConsumerState;
+
+static unsigned long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void consumer_handler(const Event* event, const void* data, size_t length, void* ctx)
+{
+    ConsumerState* state = ctx;
+    BenchPayload payload;
+    (void)event; (void)length;
+
+    memcpy(&payload, data, sizeof(payload));
+    if (state->count < state->capacity)
+    {
+        state->latencies[state->count++] = now_ns() - payload.sent_ns;
+    }
+    if (payload.last)
+    {
+        state->done = true;
+    }
+}
+
+static int compare_ull(const void* a, const void* b)
+{
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void report(const char* name, ConsumerState* state, double seconds)
+{
+    qsort(state->latencies, state->count, sizeof(state->latencies[0]), compare_ull);
+    printf("%-11s %10zu msgs %12.0f msgs/s  p50 %8llu ns  p99 %8llu ns\n", name,
+           state->count, state->count / seconds,
+           state->latencies[state->count / 2], state->latencies[state->count * 99 / 100]);
+}
+
+static int run_consumer(size_t messages)
+{
+    ConsumerState state = { 0 };
+    EventShm shm;
+    Event event;
+    int phase;
+
+    if (!event_shm_open(&shm, SEGMENT_NAME))
+    {
+        perror("event_shm_open");
+        return 1;
+    }
+    state.capacity = messages;
+    state.latencies = malloc(messages * sizeof(*state.latencies));
+    event_initialize(&event);
+    event_subscribe_ctx(&event, consumer_handler, &state);
+
+    for (phase = 0; phase < 2; phase++)
+    {
+        unsigned long long start = 0;
+        state.count = 0;
+        state.done = false;
+        while (!state.done)
+        {
+            if (event_shm_poll(&shm, &event, 1000) > 0 && start == 0)
+            {
+                start = now_ns();
+            }
+        }
+        report(phase == 0 ? "throughput" : "latency", &state, (now_ns() - start) / 1e9);
+    }
+
+    event_deinitialize(&event);
+    event_shm_close(&shm);
+    free(state.latencies);
+    return 0;
+}
+
+static void publish_all(EventShm* shm, size_t messages, size_t payload_bytes,
+                        unsigned long long pace_ns)
+{
+    unsigned char buffer[65536] = { 0 };
+    size_t i;
+
+    for (i = 0; i < messages; i++)
+    {
+        BenchPayload payload;
+        payload.header.type = 1;
+        payload.last = i + 1 == messages;
+        payload.sent_ns = now_ns();
+        memcpy(buffer, &payload, sizeof(payload));
+        while (!event_shm_publish(shm, buffer, payload_bytes))
+        {
+            sched_yield();
+        }
+        if (pace_ns)
+        {
+            unsigned long long until = now_ns() + pace_ns;
+            while (now_ns() < until)
+            {
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t messages = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t payload_bytes = argc > 2 ? strtoul(argv[2], NULL, 10) : 64;
+    EventShm shm;
+    pid_t child;
+    int i, status;
+
+    if (payload_bytes < sizeof(BenchPayload))
+    {
+        payload_bytes = sizeof(BenchPayload);
+    }
+    if (payload_bytes > 65536)
+    {
+        payload_bytes = 65536;
+    }
+    // A segment left over from an interrupted run would make create fail.
+    event_shm_unlink(SEGMENT_NAME);
+    if (!event_shm_create(&shm, SEGMENT_NAME, RING_BYTES))
+    {
+        perror("event_shm_create");
+        return 1;
+    }
+
+    printf("%zu-byte payloads, %u KiB ring\n", payload_bytes, RING_BYTES >> 10);
+    fflush(stdout);
+    child = fork();
+    if (child == 0)
+    {
+        return run_consumer(messages);
+    }
+
+    // Publish only once the consumer is attached, or its cursor would
+    // start after the first messages.
+    for (;;)
+    {
+        bool attached = false;
+        for (i = 0; i < EVENT_SHM_MAX_CONSUMERS; i++)
+        {
+            attached |= __atomic_load_n(&shm.header->consumers[i].pid, __ATOMIC_ACQUIRE) != 0;
+        }
+        if (attached || waitpid(child, &status, WNOHANG) == child)
+        {
+            break;
+        }
+        usleep(1000);
+    }
+
+    publish_all(&shm, messages, payload_bytes, 0);
+    // Let the consumer drain the first phase so the two don't mix.
+    for (i = 0; i < EVENT_SHM_MAX_CONSUMERS; i++)
+    {
+        while (__atomic_load_n(&shm.header->consumers[i].active, __ATOMIC_ACQUIRE) &&
+               __atomic_load_n(&shm.header->consumers[i].read_pos, __ATOMIC_ACQUIRE) != shm.header->write_pos)
+        {
+            usleep(100);
+        }
+    }
+    publish_all(&shm, messages / 20 ? messages / 20 : 1, payload_bytes, 20000);
+
+    waitpid(child, &status, 0);
+    event_shm_close(&shm);
+    event_shm_unlink(SEGMENT_NAME);
+    return 0;
+}
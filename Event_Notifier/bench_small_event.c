@@ -0,0 +1,156 @@
+/*
+ * Benchmark for small events and per-subscriber context, at 1, 4 and 64
+ * subscribers.
+ *
+ *  lifecycle  event_initialize + subscribe N + notify + event_deinitialize.
+ *             Up to EVENT_INLINE_HANDLERS subscribers this never touches the
+ *             heap.
+ *  side map   notify with plain handlers that look their state up in a
+ *             global hash map keyed by the event (the pre-ctx workaround).
+ *  ctx        notify with context handlers that get their state directly.
+ *
+ * Build: gcc -O2 -pthread Event_notifier.c bench_small_event.c -o bench_small_event
+ * Usage: ./bench_small_event [iterations]
+ */
+
+#include "event_notifier.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#define MAP_SIZE    1024
+
+typedef struct SubscriberState
+{
+    unsigned long long calls;
+    size_t bytes;
+}SubscriberState;
+
+typedef struct MapEntry
+{
+    const Event* key;
+    SubscriberState* state;
+}MapEntry;
+
+static MapEntry state_map[MAP_SIZE];
+static SubscriberState states[64];
+
+static size_t map_hash(const Event* key)
+{
+    uintptr_t h = (uintptr_t)key;
+    h ^= h >> 17;
+    h *= 0xed5ad4bbU;
+    h ^= h >> 11;
+    return h & (MAP_SIZE - 1);
+}
+
+static void map_put(const Event* key, SubscriberState* state)
+{
+    size_t i = map_hash(key);
+    while (state_map[i].key && state_map[i].key != key)
+    {
+        i = (i + 1) & (MAP_SIZE - 1);
+    }
+    state_map[i].key = key;
+    state_map[i].state = state;
+}
+
+static SubscriberState* map_get(const Event* key)
+{
+    size_t i = map_hash(key);
+    while (state_map[i].key != key)
+    {
+        i = (i + 1) & (MAP_SIZE - 1);
+    }
+    return state_map[i].state;
+}
+
+static void plain_handler(const Event* event, const void* data, size_t length)
+{
+    SubscriberState* state = map_get(event);
+    (void)data;
+    state->calls++;
+    state->bytes += length;
+}
+
+static void ctx_handler(const Event* event, const void* data, size_t length, void* ctx)
+{
+    SubscriberState* state = ctx;
+    (void)event; (void)data;
+    state->calls++;
+    state->bytes += length;
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double bench_lifecycle(int subscribers, unsigned long iterations)
+{
+    unsigned long it;
+    int i, payload = 7;
+    double start = now_sec();
+
+    for (it = 0; it < iterations; it++)
+    {
+        Event event;
+        event_initialize(&event);
+        for (i = 0; i < subscribers; i++)
+        {
+            event_subscribe_ctx(&event, ctx_handler, &states[i]);
+        }
+        event_notify(&event, &payload, sizeof(payload));
+        event_deinitialize(&event);
+    }
+    return (now_sec() - start) * 1e9 / iterations;
+}
+
+static double bench_notify(Event* event, unsigned long iterations)
+{
+    unsigned long it;
+    int payload = 7;
+    double start = now_sec();
+
+    for (it = 0; it < iterations; it++)
+    {
+        event_notify(event, &payload, sizeof(payload));
+    }
+    return (now_sec() - start) * 1e9 / iterations;
+}
+
+int main(int argc, char* argv[])
+{
+    static const int counts[] = { 1, 4, 64 };
+    unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000000UL;
+    size_t c;
+
+    printf("ns per operation\n");
+    printf("%-12s %12s %12s %12s\n", "subscribers", "lifecycle", "side map", "ctx");
+    for (c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        int n = counts[c], i;
+        Event mapped, direct;
+        double lifecycle, mapped_ns, direct_ns;
+
+        event_initialize(&mapped);
+        event_initialize(&direct);
+        map_put(&mapped, &states[0]);
+        for (i = 0; i < n; i++)
+        {
+            event_subscribe(&mapped, plain_handler);
+            event_subscribe_ctx(&direct, ctx_handler, &states[i]);
+        }
+
+        lifecycle = bench_lifecycle(n, iterations / n);
+        mapped_ns = bench_notify(&mapped, iterations / n);
+        direct_ns = bench_notify(&direct, iterations / n);
+        printf("%-12d %12.1f %12.1f %12.1f\n", n, lifecycle, mapped_ns, direct_ns);
+
+        event_deinitialize(&mapped);
+        event_deinitialize(&direct);
+    }
+    return 0;
+}
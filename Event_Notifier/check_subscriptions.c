@@ -0,0 +1,244 @@
+/*
+ * Regression checks for subscription bookkeeping: handlers that subscribe
+ * or unsubscribe on the event that is notifying them; handles, tombstones,
+ * slot reuse and priority order mixed together; and EventBus patterns next
+ * to direct subscriptions of the same handler.
+ *
+ * Prints one line per check and exits non-zero if any of them fails.
+ *
+ * Build: gcc -O2 -pthread Event_notifier.c Event_bus.c check_subscriptions.c -o check_subscriptions
+ * Usage: ./check_subscriptions
+ */
+
+#include "event_bus.h"
+#include "event_notifier.h"
+#include <stdio.h>
+#include <string.h>
+
+static char order[64];
+static size_t order_length;
+static int failures;
+static size_t counted_calls;
+static EventHandle handles[20];
+
+static void record(char name)
+{
+    if (order_length + 1 < sizeof(order))
+    {
+        order[order_length++] = name;
+        order[order_length] = '\0';
+    }
+}
+
+static void handler_a(const Event* event, const void* data, size_t length) { (void)event; (void)data; (void)length; record('A'); }
+static void handler_b(const Event* event, const void* data, size_t length) { (void)event; (void)data; (void)length; record('B'); }
+static void handler_d(const Event* event, const void* data, size_t length) { (void)event; (void)data; (void)length; record('D'); }
+static void handler_e(const Event* event, const void* data, size_t length) { (void)event; (void)data; (void)length; record('E'); }
+static void counted(const Event* event, const void* data, size_t length) { (void)event; (void)data; (void)length; counted_calls++; }
+
+static void batch_handler(const Event* event, const EventRecord* records, size_t count)
+{
+    size_t i;
+    (void)event;
+    record('[');
+    for (i = 0; i < count; i++)
+    {
+        EventHeader header;
+        memcpy(&header, records[i].data, sizeof(header));
+        record((char)('0' + header.type));
+    }
+    record(']');
+}
+
+static void check(const char* name, bool ok)
+{
+    printf("%-48s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+static const char* notify_order(Event* event)
+{
+    order_length = 0;
+    order[0] = '\0';
+    event_notify(event, NULL, 0);
+    return order;
+}
+
+// Subscribing from a handler grows the array under the running notify; the
+// handlers after the subscribing one must still be read from the new array.
+static void subscribe_many(const Event* event, const void* data, size_t length)
+{
+    int i;
+    (void)data;
+    (void)length;
+    for (i = 0; i < 40; i++)
+    {
+        event_subscribe((Event*)event, counted);
+    }
+}
+
+static void check_subscribe_from_handler(bool batch)
+{
+    EventRecord record = { NULL, 0 };
+    Event event;
+    int i;
+
+    event_initialize(&event);
+    event_subscribe(&event, subscribe_many);
+    for (i = 0; i < 19; i++)
+    {
+        event_subscribe(&event, counted);
+    }
+    counted_calls = 0;
+    batch ? event_notify_batch(&event, &record, 1) : event_notify(&event, NULL, 0);
+    check(batch ? "subscribe from first handler of 20 (batch)" : "subscribe from first handler of 20",
+          counted_calls == 19 + 40);
+    event_deinitialize(&event);
+}
+
+// Enough tombstones for compaction, starting with the running handler: the
+// array must stay put until the notify is over, or handler 10 is skipped.
+static void unsubscribe_many(const Event* event, const void* data, size_t length)
+{
+    int i;
+    (void)data;
+    (void)length;
+    for (i = 0; i < 10; i++)
+    {
+        event_unsubscribe_handle((Event*)event, handles[i]);
+    }
+}
+
+static void check_unsubscribe_from_handler(void)
+{
+    Event event;
+    int i;
+
+    event_initialize(&event);
+    handles[0] = event_subscribe(&event, unsubscribe_many);
+    for (i = 1; i < 20; i++)
+    {
+        handles[i] = event_subscribe(&event, counted);
+    }
+    counted_calls = 0;
+    event_notify(&event, NULL, 0);
+    check("unsubscribe from first handler of 20", counted_calls == 10);
+    check("compacted once the notify returned", event.count == 10 && event.tombstones == 0);
+    event_deinitialize(&event);
+}
+
+// A priority insert shifts entries to the right; a tombstone among them
+// must not write its stale slot number back into the slot table.
+static void check_priority_after_handle_unsubscribe(bool concurrent)
+{
+    EventSubscribeOptions high = { 5, 0 };
+    EventHandle a, d;
+    Event event;
+
+    concurrent ? event_initialize_concurrent(&event) : event_initialize(&event);
+    a = event_subscribe(&event, handler_a);
+    event_subscribe(&event, handler_b);
+    event_unsubscribe_handle(&event, a);
+    d = event_subscribe(&event, handler_d);    // reuses A's slot
+    event_subscribe_opts(&event, handler_e, &high);
+
+    check(concurrent ? "priority order after slot reuse (concurrent)" : "priority order after slot reuse",
+          strcmp(notify_order(&event), "EBD") == 0);
+    check(concurrent ? "handle still valid after shift (concurrent)" : "handle still valid after shift",
+          event_unsubscribe_handle(&event, d));
+    check(concurrent ? "unsubscribed handler not called (concurrent)" : "unsubscribed handler not called",
+          strcmp(notify_order(&event), "EB") == 0);
+    check(concurrent ? "stale handle rejected (concurrent)" : "stale handle rejected",
+          !event_unsubscribe_handle(&event, d) && !event_unsubscribe_handle(&event, a));
+    event_deinitialize(&event);
+}
+
+static void check_filtered_batch_handler(void)
+{
+    EventSubscribeOptions options = { 0, 1u << 1 };
+    EventHeader headers[5] = { { 2 }, { 2 }, { 1 }, { 2 }, { 4 } };
+    EventRecord records[5];
+    Event event;
+    size_t i;
+
+    for (i = 0; i < 5; i++)
+    {
+        records[i].data = &headers[i];
+        records[i].length = sizeof(headers[i]);
+    }
+    event_initialize(&event);
+    event_subscribe_batch_opts(&event, batch_handler, &options);
+    order_length = 0;
+    order[0] = '\0';
+    event_notify_batch(&event, records, 5);
+    check("filtered batch handler gets accepted runs", strcmp(order, "[22][2]") == 0);
+    event_deinitialize(&event);
+}
+
+// A higher-priority handler subscribed from a handler runs at the end of
+// the current notify and in priority order from the next one on.
+static void subscribe_high(const Event* event, const void* data, size_t length)
+{
+    EventSubscribeOptions high = { 5, 0 };
+    (void)data;
+    (void)length;
+    record('S');
+    if (!strchr(order, 'E'))
+    {
+        event_subscribe_opts((Event*)event, handler_e, &high);
+    }
+}
+
+static void check_priority_subscribe_from_handler(void)
+{
+    Event event;
+
+    event_initialize(&event);
+    event_subscribe(&event, subscribe_high);
+    event_subscribe(&event, handler_b);
+    check("priority subscribe from handler, same notify", strcmp(notify_order(&event), "SBE") == 0);
+    check("priority subscribe from handler, next notify", strcmp(notify_order(&event), "ESB") == 0);
+    event_deinitialize(&event);
+}
+
+// Unsubscribing a pattern must remove only what the pattern subscribed,
+// not a direct subscription of the same handler on a matching topic.
+static void check_pattern_next_to_direct_subscription(void)
+{
+    EventBus bus;
+    EventHandle direct;
+    uint32_t id;
+
+    event_bus_initialize(&bus);
+    direct = event_bus_subscribe(&bus, "sensors.temp", handler_a);
+    id = event_bus_lookup(&bus, "sensors.temp");
+    event_bus_subscribe_pattern(&bus, "sensors.*", handler_a);
+    check("pattern and direct subscription both called", strcmp(notify_order(bus.events[id]), "AA") == 0);
+    check("pattern unsubscribe", event_bus_unsubscribe_pattern(&bus, "sensors.*", handler_a));
+    check("direct subscription survives pattern unsubscribe", strcmp(notify_order(bus.events[id]), "A") == 0);
+    check("direct handle still valid", event_bus_unsubscribe(&bus, id, direct));
+    check("nothing left subscribed", strcmp(notify_order(bus.events[id]), "") == 0);
+
+    event_bus_subscribe_pattern(&bus, "sensors.*", handler_b);
+    id = event_bus_intern(&bus, "sensors.humidity");
+    event_bus_subscribe(&bus, "sensors.humidity", handler_b);
+    event_bus_unsubscribe_pattern(&bus, "sensors.*", handler_b);
+    check("late topic keeps its direct subscription", strcmp(notify_order(bus.events[id]), "B") == 0);
+    event_bus_deinitialize(&bus);
+}
+
+int main(void)
+{
+    check_subscribe_from_handler(false);
+    check_subscribe_from_handler(true);
+    check_unsubscribe_from_handler();
+    check_priority_after_handle_unsubscribe(false);
+    check_priority_after_handle_unsubscribe(true);
+    check_priority_subscribe_from_handler();
+    check_filtered_batch_handler();
+    check_pattern_next_to_direct_subscription();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,97 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include "event_notifier.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EVENT_BUS_INVALID_TOPIC    UINT32_MAX
+
+// Interned topic: ids are dense indices into EventBus.events/topics.
+typedef struct EventBusTopic
+{
+    char* name;
+    size_t length;
+    uint32_t hash;
+}EventBusTopic;
+
+// Subscription a pattern made on one topic's Event.
+typedef struct EventBusPatternHandle
+{
+    uint32_t topic;
+    EventHandle handle;
+}EventBusPatternHandle;
+
+// Wildcard subscription. A pattern ending in '*' matches every topic that
+// starts with the text before it ("sensors.*", or "*" for all topics);
+// anything else matches one topic exactly. handles records what the
+// pattern subscribed, so unsubscribing it leaves direct subscriptions of
+// the same handler alone.
+typedef struct EventBusPattern
+{
+    char* prefix;
+    size_t length;
+    bool wildcard;
+    EventHandler handler;
+    EventBusPatternHandle* handles;
+    size_t handle_count;
+    size_t handle_capacity;
+}EventBusPattern;
+
+typedef struct EventBus
+{
+    // Open-addressing table of topic id + 1 (0 = empty), linear probing.
+    uint32_t* table;
+    size_t table_size;
+
+    Event** events;
+    EventBusTopic* topics;
+    size_t topic_count;
+    size_t topic_capacity;
+
+    EventBusPattern* patterns;
+    size_t pattern_count;
+    size_t pattern_capacity;
+}EventBus;
+
+// The bus itself is not thread-safe: intern topics and manage patterns from
+// one thread (or under a lock). Notifying by id only reads the bus.
+bool event_bus_initialize(EventBus* bus);
+void event_bus_deinitialize(EventBus* bus);
+
+// Returns the id of topic, creating its Event (and applying every matching
+// wildcard subscription) the first time the topic is seen.
+uint32_t event_bus_intern(EventBus* bus, const char* topic);
+// Returns the id of an existing topic or EVENT_BUS_INVALID_TOPIC.
+uint32_t event_bus_lookup(const EventBus* bus, const char* topic);
+// The Event behind a topic id, for the rest of the Event API.
+Event* event_bus_event(const EventBus* bus, uint32_t topic_id);
+
+EventHandle event_bus_subscribe(EventBus* bus, const char* topic, EventHandler handler);
+bool event_bus_unsubscribe(EventBus* bus, uint32_t topic_id, EventHandle handle);
+// Subscribes handler on every matching topic, or on none: returns false
+// (and undoes the partial work) if any subscription fails. Topics interned
+// later that match get the handler too; if that fails, interning fails.
+bool event_bus_subscribe_pattern(EventBus* bus, const char* pattern, EventHandler handler);
+bool event_bus_unsubscribe_pattern(EventBus* bus, const char* pattern, EventHandler handler);
+
+// Hot path: no string hashing, just an index into the event table.
+static inline void event_bus_notify(const EventBus* bus, uint32_t topic_id,
+                                    const void* data, size_t length)
+{
+    if (topic_id < bus->topic_count)
+    {
+        event_notify(bus->events[topic_id], data, length);
+    }
+}
+
+// Convenience path that hashes the name; unknown topics are ignored.
+void event_bus_notify_topic(const EventBus* bus, const char* topic, const void* data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EVENT_BUS_H
@@ -0,0 +1,108 @@
+#ifndef EVENT_DISPATCHER_H
+#define EVENT_DISPATCHER_H
+
+#include "event_notifier.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Payloads up to this size are copied into the queue cell itself; larger
+// ones are copied into a heap buffer owned by the cell until dispatched.
+#define EVENT_ASYNC_INLINE_PAYLOAD    88
+
+// What event_notify_async() does when the queue is full.
+typedef enum EventBackpressure
+{
+    EVENT_BACKPRESSURE_BLOCK,         // wait for a dispatcher to free a cell
+    EVENT_BACKPRESSURE_DROP_OLDEST,   // discard the oldest queued message
+    EVENT_BACKPRESSURE_DROP_NEWEST    // discard the message being posted
+}EventBackpressure;
+
+typedef struct EventQueueCell
+{
+    unsigned long long sequence;
+    Event* event;
+    void* heap_data;
+    size_t length;
+    unsigned long long enqueue_ns;
+    bool reliable;                    // never discarded by a drop policy
+    unsigned char inline_data[EVENT_ASYNC_INLINE_PAYLOAD];
+}EventQueueCell;
+
+// A queue cell claimed by event_async_reserve(), waiting for its payload.
+typedef struct EventAsyncSlot
+{
+    EventQueueCell* cell;
+    unsigned long long position;
+    void* data;                       // where to write the length bytes
+}EventAsyncSlot;
+
+typedef struct EventDispatchStats
+{
+    size_t depth;                          // messages currently queued
+    unsigned long long enqueued;
+    unsigned long long dispatched;
+    unsigned long long dropped;
+    unsigned long long queue_total_ns;     // enqueue -> picked up by a worker
+    unsigned long long queue_max_ns;
+    unsigned long long latency_total_ns;   // enqueue -> all handlers returned
+    unsigned long long latency_max_ns;
+}EventDispatchStats;
+
+typedef struct EventDispatcher
+{
+    // Bounded MPMC ring (Vyukov): each cell's sequence says whether it is
+    // free for the producer at that position or full for the consumer.
+    EventQueueCell* cells;
+    size_t mask;
+    unsigned long long enqueue_pos __attribute__((aligned(64)));
+    unsigned long long dequeue_pos __attribute__((aligned(64)));
+
+    EventBackpressure policy __attribute__((aligned(64)));
+    pthread_t* workers;
+    size_t worker_count;
+
+    // Only used to park idle workers and blocked producers.
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    int sleeping_workers;
+    int sleeping_producers;
+    bool stopping;
+
+    unsigned long long enqueued __attribute__((aligned(64)));
+    unsigned long long dropped;
+    unsigned long long dispatched __attribute__((aligned(64)));
+    unsigned long long queue_total_ns;
+    unsigned long long queue_max_ns;
+    unsigned long long latency_total_ns;
+    unsigned long long latency_max_ns;
+}EventDispatcher;
+
+// capacity is rounded up to a power of two. Events posted to the dispatcher
+// should be concurrent (event_initialize_concurrent) if they are subscribed
+// to while dispatcher threads are running.
+bool event_dispatcher_initialize(EventDispatcher* dispatcher, size_t capacity,
+                                 size_t worker_count, EventBackpressure policy);
+// Dispatches everything still queued, then stops and joins the workers.
+void event_dispatcher_deinitialize(EventDispatcher* dispatcher);
+// Copies data and queues it for event_notify() on a dispatcher thread.
+// Returns false if the message was dropped or the dispatcher is stopping.
+bool event_notify_async(EventDispatcher* dispatcher, Event* event, const void* data, size_t length);
+// event_notify_async() in two steps, for payloads assembled from several
+// pieces: reserve claims a cell (applying the backpressure policy) and
+// points slot->data at room for length bytes, commit queues it. Cells
+// behind an uncommitted one are not dispatched, so fill it right away.
+// A reliable message is never dropped: it waits for room whatever the
+// policy, and DROP_OLDEST discards the new message rather than it.
+bool event_async_reserve(EventDispatcher* dispatcher, Event* event, size_t length,
+                         bool reliable, EventAsyncSlot* slot);
+void event_async_commit(EventDispatcher* dispatcher, EventAsyncSlot* slot);
+void event_dispatcher_get_stats(EventDispatcher* dispatcher, EventDispatchStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EVENT_DISPATCHER_H
@@ -3,26 +3,222 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #define INIT_CAPACITY    16
+
+// Maximum number of threads that can run event_notify() lock-free on
+// concurrent events. Threads beyond this limit fall back to the writer lock.
+#define EVENT_MAX_READERS    128
+
+// Unsubscribing leaves a tombstone; the handler array is compacted once at
+// least this many tombstones make up half of it.
+#define EVENT_COMPACT_MIN_TOMBSTONES    8
+
+#define EVENT_INVALID_SLOT    UINT32_MAX
+
+// Subscriptions stored inside Event itself before the first heap allocation.
+#define EVENT_INLINE_HANDLERS    4
+
+struct Event;
+typedef void (*EventHandler)(const struct Event*, const void*, size_t);
+
+// One payload of a batch passed to event_notify_batch().
+typedef struct EventRecord
+{
+    const void* data;
+    size_t length;
+}EventRecord;
+
+// Batch-aware handler: receives all records of a batch in a single call.
+typedef void (*EventBatchHandler)(const struct Event*, const EventRecord*, size_t);
+
+// Handler with per-subscriber state: ctx is the pointer given at subscribe.
+typedef void (*EventContextHandler)(const struct Event*, const void*, size_t, void* ctx);
+
+typedef enum EventHandlerKind
+{
+    EVENT_HANDLER_NONE,       // tombstone left by unsubscribe
+    EVENT_HANDLER_PLAIN,
+    EVENT_HANDLER_BATCH,
+    EVENT_HANDLER_CONTEXT
+}EventHandlerKind;
+
+// A handler together with its context pointer; kind says which member of
+// the union is set.
+typedef struct EventSubscription
+{
+    union
+    {
+        EventHandler handler;
+        EventBatchHandler batch_handler;
+        EventContextHandler context_handler;
+    };
+    void* ctx;
+    uint32_t slot;
+    uint32_t kind;
+    int32_t priority;        // higher runs first
+    uint32_t filter_mask;    // 0 = every payload
+}EventSubscription;
+
+// Optional header at the start of a payload. A subscription with a non-zero
+// filter_mask is only called when (header.type & filter_mask) != 0, so
+// uninteresting messages are skipped without calling the handler.
+typedef struct EventHeader
+{
+    uint32_t type;
+}EventHeader;
+
+typedef struct EventSubscribeOptions
+{
+    int32_t priority;        // dispatch order, highest first; default 0
+    uint32_t filter_mask;    // matched against EventHeader.type; 0 = no filter
+}EventSubscribeOptions;
+
+// Returned by event_subscribe(). Stays valid while handlers around it come
+// and go; a stale handle (already unsubscribed) is rejected by generation.
+typedef struct EventHandle
+{
+    uint32_t slot;
+    uint32_t generation;
+}EventHandle;
+
+// Stable indirection from a handle to its entry in Event.handlers. Free
+// slots form a list through index.
+typedef struct EventSlot
+{
+    uint32_t generation;
+    uint32_t index;
+}EventSlot;
+
+// Copy of the handler list published to readers in concurrent mode, with
+// the same layout as Event.handlers. Unsubscribe only turns an entry into a
+// tombstone in place; everything else is replaced by publishing a new
+// snapshot.
+typedef struct EventSnapshot
+{
+    size_t count;
+    EventSubscription handlers[];
+}EventSnapshot;
+
+typedef struct EventCoalescer EventCoalescer;
+
+typedef struct EventCoalesceStats
+{
+    unsigned long long received;     // notifications posted while coalescing
+    unsigned long long delivered;    // notifications actually dispatched
+    size_t pending;
+    size_t keys;
+}EventCoalesceStats;
+
 typedef struct Event
 {
     // Create fileds of this struct as you need.
-    void (**handlers)(const struct Event*, const void*, size_t);
-    size_t count;
+    EventSubscription* handlers;
+    size_t count;         // entries in handlers, tombstones included
     size_t capacity;
+    size_t tombstones;
+
+    EventSlot* slots;
+    size_t slot_count;
+    size_t slot_capacity;
+    uint32_t free_slot;
+
+    // Number of event_notify()/event_notify_batch() calls running on a
+    // non-concurrent event (nested or on other threads). While it is
+    // non-zero, compaction is deferred and subscriptions made by handlers
+    // are appended; unsorted is set when one of them still has to move to
+    // its priority position.
+    unsigned int notifying;
+    bool unsorted;
+
+    // Concurrent mode only: handlers/count/capacity are the writer's copy
+    // guarded by write_lock, snapshot is what event_notify() reads.
+    bool concurrent;
+    EventSnapshot* snapshot;
+    pthread_mutex_t write_lock;
+
+    // Non-NULL while coalescing is enabled.
+    EventCoalescer* coalescer;
+
+    // Small-buffer storage: handlers and slots point here until they
+    // outgrow it, so an initialized Event must not be copied or moved.
+    EventSubscription inline_handlers[EVENT_INLINE_HANDLERS];
+    EventSlot inline_slots[EVENT_INLINE_HANDLERS];
 }Event;
 
+// Handlers may subscribe and unsubscribe on the event that is notifying
+// them; handlers subscribed that way are called later in the same notify
+// and take their priority position once it returns.
 void event_initialize(Event* event);
+// Like event_initialize(), but subscribe/unsubscribe may run on any thread
+// while other threads call event_notify(). Notify takes no lock: it reads
+// the current snapshot, and writers wait for readers of the old snapshot to
+// finish before freeing it. Handlers must not subscribe/unsubscribe on the
+// event that is invoking them.
+void event_initialize_concurrent(Event* event);
 void event_deinitialize(Event* event);
-bool event_subscribe(Event* event, void (*handler)(const Event*, const void*, size_t));
+// Returns a handle whose slot is EVENT_INVALID_SLOT on allocation failure.
+EventHandle event_subscribe(Event* event, void (*handler)(const Event*, const void*, size_t));
+// Removes the first subscription of handler (linear search).
 bool event_unsubscribe(Event* event, void (*handler)(const Event*, const void*, size_t));
+// Removes the subscription behind handle in O(1). On a concurrent event it
+// then waits until no thread can still be calling the handler; that wait
+// depends on the number of notifying threads, not on the handler count.
+bool event_unsubscribe_handle(Event* event, EventHandle handle);
+// Subscribes handler with a context pointer passed back on every call.
+EventHandle event_subscribe_ctx(Event* event, EventContextHandler handler, void* ctx);
+// Removes the first subscription matching both handler and ctx.
+bool event_unsubscribe_ctx(Event* event, EventContextHandler handler, void* ctx);
+// Subscribe with a priority and/or type filter. Handlers run in priority
+// order (ties in subscription order); the order is maintained at subscribe
+// time, never on notify.
+EventHandle event_subscribe_opts(Event* event, EventHandler handler,
+                                 const EventSubscribeOptions* options);
+EventHandle event_subscribe_ctx_opts(Event* event, EventContextHandler handler, void* ctx,
+                                     const EventSubscribeOptions* options);
 void event_notify(Event* event, const void* data, size_t length);
 
+// Coalescing mode: notifications are not dispatched immediately; the
+// latest payload per key is kept (copied) and delivered once by the next
+// flush, so each key reaches every subscriber at most once per flush.
+// Flushes come from a timer thread every interval_ms (timer_thread), or
+// from event_flush(), or, without a timer, from the first notify after
+// interval_ms has passed. event_notify() uses key 0;
+// event_notify_batch() bypasses coalescing. A handler may notify the event
+// it is being flushed for; that payload waits for the following flush.
+bool event_enable_coalescing(Event* event, unsigned int interval_ms, bool timer_thread);
+// Stops the timer, delivers whatever is pending and leaves coalescing mode.
+// Other threads may keep notifying meanwhile: their updates are delivered,
+// and it returns once none of them still uses the coalescer. Must not be
+// called from a handler of the event.
+void event_disable_coalescing(Event* event);
+void event_notify_keyed(Event* event, uint64_t key, const void* data, size_t length);
+// Delivers every pending key now; returns the number delivered.
+size_t event_flush(Event* event);
+void event_get_coalesce_stats(Event* event, EventCoalesceStats* stats);
+
+static inline bool event_handle_valid(EventHandle handle)
+{
+    return handle.slot != EVENT_INVALID_SLOT;
+}
+
+// Batch handlers also receive single event_notify() payloads as a batch of
+// one; plain handlers are called once per record by event_notify_batch().
+EventHandle event_subscribe_batch(Event* event, EventBatchHandler handler);
+// With a filter_mask, a batch handler gets each run of consecutive accepted
+// records of a batch as a separate call.
+EventHandle event_subscribe_batch_opts(Event* event, EventBatchHandler handler,
+                                       const EventSubscribeOptions* options);
+bool event_unsubscribe_batch(Event* event, EventBatchHandler handler);
+// Delivers records[0..record_count) to every handler, handler by handler.
+void event_notify_batch(Event* event, const EventRecord* records, size_t record_count);
+
 #ifdef __cplusplus
 }
 #endif
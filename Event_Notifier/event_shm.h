@@ -0,0 +1,79 @@
+#ifndef EVENT_SHM_H
+#define EVENT_SHM_H
+
+#include "event_notifier.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EVENT_SHM_MAGIC            0x45564e54u    // "EVNT"
+#define EVENT_SHM_VERSION          1
+#define EVENT_SHM_MAX_CONSUMERS    16
+
+// Per-consumer cursor, one cache line each so consumers never share a line.
+typedef struct EventShmConsumer
+{
+    uint64_t read_pos;
+    uint32_t active;
+    int32_t pid;
+    char pad[48];
+}EventShmConsumer;
+
+// Start of the shared segment; the ring data follows it. Positions are
+// byte counters that only grow, the ring offset is pos & (data_size - 1).
+typedef struct EventShmHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t data_size;
+
+    uint64_t write_pos __attribute__((aligned(64)));
+
+    // Futex word bumped on every publish; consumers sleep on it.
+    uint32_t wake_seq __attribute__((aligned(64)));
+    uint32_t waiters;
+
+    EventShmConsumer consumers[EVENT_SHM_MAX_CONSUMERS] __attribute__((aligned(64)));
+}EventShmHeader;
+
+typedef struct EventShm
+{
+    EventShmHeader* header;
+    unsigned char* data;
+    size_t map_size;
+    int consumer;           // consumer slot, -1 for the producer
+    uint64_t reserve_pos;   // producer: where the reserved record starts
+}EventShm;
+
+// Producer side. Creates the POSIX shared memory object name, e.g.
+// "/sensors", with mode 0600 and a ring of data_size bytes rounded up to a
+// power of two. Each segment has exactly one producer process. Fails with
+// EEXIST if name already exists; a segment left behind by a producer that
+// died has to be removed with event_shm_unlink() first.
+bool event_shm_create(EventShm* shm, const char* name, size_t data_size);
+// Consumer side. Attaches to an existing segment and starts reading at the
+// current write position. Every consumer sees every record (broadcast).
+bool event_shm_open(EventShm* shm, const char* name);
+void event_shm_close(EventShm* shm);
+int event_shm_unlink(const char* name);
+
+// Reserves room for a length-byte record directly in the segment and
+// returns where to write it, or NULL if the slowest consumer has not yet
+// freed enough space. event_shm_commit() makes it visible to consumers.
+void* event_shm_reserve(EventShm* shm, size_t length);
+void event_shm_commit(EventShm* shm, size_t length);
+// reserve + memcpy + commit.
+bool event_shm_publish(EventShm* shm, const void* data, size_t length);
+
+// Delivers every pending record to event through event_notify(). The
+// payload pointer points into the segment (no copy) and is only valid
+// until the handler returns. Waits up to timeout_ms for the first record
+// (-1 = forever, 0 = don't wait); returns the number of records delivered.
+size_t event_shm_poll(EventShm* shm, Event* event, int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EVENT_SHM_H
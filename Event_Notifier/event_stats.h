@@ -0,0 +1,53 @@
+#ifndef EVENT_STATS_H
+#define EVENT_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-handler dispatch statistics for Event_notifier.c. Recording only
+// happens when the library is built with -DEVENT_INSTRUMENT; otherwise the
+// hooks compile to nothing and snapshots are empty.
+//
+// Every thread records into its own table (no shared cache lines on the
+// hot path); snapshots merge all tables. Cost is in TSC cycles on x86 and
+// in nanoseconds elsewhere.
+
+#define EVENT_STATS_BUCKETS         32     // bucket b: cost < 2^b
+#define EVENT_STATS_TABLE_SIZE      256    // handlers tracked per thread
+
+typedef struct EventHandlerStats
+{
+    const void* handler;       // NULL collects handlers past the table size
+    unsigned long long calls;
+    unsigned long long cost;
+    unsigned long long histogram[EVENT_STATS_BUCKETS];
+}EventHandlerStats;
+
+// Fills out with up to max entries, most expensive handler first, and
+// returns the number of handlers seen.
+size_t event_stats_snapshot(EventHandlerStats* out, size_t max);
+// Writes a table of calls, total/average cost and p50/p99 per handler.
+void event_stats_dump(FILE* stream);
+
+#ifdef EVENT_INSTRUMENT
+uint64_t event_stats_now(void);
+void event_stats_record(const void* handler, unsigned long long calls, uint64_t cost);
+
+#define EVENT_STATS_START(name)    uint64_t name = event_stats_now()
+#define EVENT_STATS_STOP(name, handler, calls) \
+    event_stats_record((const void*)(handler), (calls), event_stats_now() - (name))
+#else
+#define EVENT_STATS_START(name)                   do { } while (0)
+#define EVENT_STATS_STOP(name, handler, calls)    ((void)(handler), (void)(calls))
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EVENT_STATS_H
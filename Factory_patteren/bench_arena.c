@@ -0,0 +1,91 @@
+/**
+ * @file bench_arena.c
+ * @brief Benchmark of arena-backed shape creation against malloc.
+ * @details Creates [count] shapes, cycling through the four types, and
+ *          destroys them again:
+ *          - malloc: shape_create() per shape, shape_destroy() per shape
+ *          - arena:  shape_arena_create_shape() per shape, one
+ *                    shape_arena_destroy() for all of them
+ *          - reset:  an arena with one chunk big enough for every shape,
+ *                    filled once and then again after shape_arena_reset(),
+ *                    so the memory is already mapped
+ *
+ *          Build: gcc -O2 shape.c bench_arena.c -o bench_arena -lm
+ *          Usage: ./bench_arena [count]
+ */
+
+#include "shape.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @brief Monotonic time in seconds.
+ */
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Print one result line.
+ */
+static void report(const char *name, size_t count, double create, double destroy)
+{
+    printf("%-7s create %6.1f ns/shape   destroy %6.1f ns/shape   total %7.1f ms\n",
+           name, create * 1e9 / count, destroy * 1e9 / count, (create + destroy) * 1e3);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    shape_t *shapes = malloc(count * sizeof(*shapes));
+    struct shape_arena *arena;
+    double start, create;
+    size_t i;
+
+    if (!shapes) return 1;
+    printf("%zu shapes\n", count);
+
+    start = now_s();
+    for (i = 0; i < count; i++) {
+        shapes[i] = shape_create((enum shape_type)(i & 3));
+    }
+    create = now_s() - start;
+    start = now_s();
+    for (i = 0; i < count; i++) {
+        shape_destroy(shapes[i]);
+    }
+    report("malloc", count, create, now_s() - start);
+
+    arena = shape_arena_create(0);
+    start = now_s();
+    for (i = 0; i < count; i++) {
+        shapes[i] = shape_arena_create_shape(arena, (enum shape_type)(i & 3));
+    }
+    create = now_s() - start;
+    start = now_s();
+    shape_arena_destroy(arena);
+    report("arena", count, create, now_s() - start);
+
+    /* Every type is a vtable pointer plus at most two floats. */
+    arena = shape_arena_create(count * 2 * sizeof(void *));
+    for (i = 0; i < count; i++) {
+        shape_arena_create_shape(arena, (enum shape_type)(i & 3));
+    }
+    shape_arena_reset(arena);
+    start = now_s();
+    for (i = 0; i < count; i++) {
+        shapes[i] = shape_arena_create_shape(arena, (enum shape_type)(i & 3));
+    }
+    create = now_s() - start;
+    start = now_s();
+    shape_arena_reset(arena);
+    report("reset", count, create, now_s() - start);
+    shape_arena_destroy(arena);
+
+    free(shapes);
+    return 0;
+}
@@ -0,0 +1,182 @@
+/**
+ * @file bench_kernels.c
+ * @brief Benchmark of the vectorized shape store kernels.
+ * @details Fills a shape store with [count] shapes of random types and
+ *          times total area, total perimeter and bounds with the scalar, SSE
+ *          and AVX2 kernels (best of [rounds]). The table shows nanoseconds
+ *          per shape and the rate at which the parameter arrays are read.
+ *          The baseline is the object path: shape_area(), shape_perimeter()
+ *          and shape_get_bounds() through the vtable for up to 10M shapes
+ *          from shape_create(), of the same types as the store and at its
+ *          dimensions (the shape_create() defaults).
+ *
+ *          Every path has to reproduce the others' results within
+ *          TOLERANCE, or the benchmark reports the mismatch and exits with
+ *          1. The objects take part only when [count] is at most 10M.
+ *
+ *          Build: gcc -O2 shape.c shape_store.c shape_kernels.c bench_kernels.c -o bench_kernels -lm
+ *          Usage: ./bench_kernels [count] [rounds]
+ */
+
+#include "shape.h"
+#include "shape_kernels.h"
+#include "shape_store.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** @brief Largest collection of shape_t objects built for the baseline. */
+#define MAX_OBJECTS 10000000
+
+/**
+ * @brief Largest relative difference between two paths' results.
+ * @details The vector kernels add float lanes over 4096-shape blocks, the
+ *          scalar kernels and the objects add doubles; that difference
+ *          stays far below 1e-4.
+ */
+#define TOLERANCE 1e-4
+
+/**
+ * @brief Monotonic time in seconds.
+ */
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Print one result line, checking the result against the reference.
+ * @return int 1 if the result is off by more than TOLERANCE, else 0.
+ */
+static int report(const char *name, const char *op, double seconds, size_t count, size_t bytes,
+                  double result, double reference)
+{
+    int mismatch = fabs(result - reference) > TOLERANCE * fabs(reference);
+
+    printf("%-7s %-9s %6.2f ns/shape  %6.2f GB/s  (%.6g)%s\n",
+           name, op, seconds * 1e9 / count, bytes / seconds / 1e9, result,
+           mismatch ? "  MISMATCH" : "");
+    return mismatch;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 5;
+    size_t objects = count < MAX_OBJECTS ? count : MAX_OBJECTS;
+    struct shape_store *store = shape_store_create();
+    shape_t *shapes = malloc(objects * sizeof(*shapes));
+    const char *ops[3] = { "area", "perimeter", "bounds" };
+    double reference[3];
+    size_t i, bytes;
+    int level, round, op, mismatches = 0;
+
+    if (!store || !shapes) return 1;
+    srand(3);
+    for (i = 0; i < count; i++) {
+        enum shape_type type = (enum shape_type)(rand() & 3);
+        if (i < objects) {
+            shapes[i] = shape_create(type);
+        }
+        /* Same dimensions as the shape_create() defaults. */
+        switch (type)
+        {
+            case CIRCLE:    shape_store_add_circle(store, 10.0f); break;
+            case RECTANGLE: shape_store_add_rectangle(store, 20.0f, 10.0f); break;
+            case TRIANGLE:  shape_store_add_triangle(store, 15.0f, 10.0f); break;
+            case SQUARE:    shape_store_add_square(store, 10.0f); break;
+        }
+    }
+    bytes = sizeof(float) * (store->circles.count + 2 * store->rectangles.count +
+                             2 * store->triangles.count + store->squares.count);
+    printf("%zu shapes (%zu MB of parameters), best of %d, best kernels: %s, tolerance %g\n",
+           count, bytes >> 20, rounds, shape_simd_name(shape_simd_best()), TOLERANCE);
+
+    {
+        double best[3] = { 1e30, 1e30, 1e30 }, result[3] = { 0, 0, 0 };
+
+        for (round = 0; round < rounds; round++) {
+            struct shape_bounds bounds = { 0, 0, 0, 0 };
+            double start = now_s(), t;
+
+            result[0] = 0;
+            for (i = 0; i < objects; i++) {
+                result[0] += shape_area(shapes[i]);
+            }
+            t = now_s() - start;
+            if (t < best[0]) best[0] = t;
+
+            start = now_s();
+            result[1] = 0;
+            for (i = 0; i < objects; i++) {
+                result[1] += shape_perimeter(shapes[i]);
+            }
+            t = now_s() - start;
+            if (t < best[1]) best[1] = t;
+
+            start = now_s();
+            for (i = 0; i < objects; i++) {
+                struct shape_bounds b = shape_get_bounds(shapes[i]);
+                if (b.max_x > bounds.max_x) bounds.max_x = b.max_x;
+            }
+            t = now_s() - start;
+            if (t < best[2]) best[2] = t;
+            result[2] = bounds.max_x;
+        }
+        /* Objects only cover the whole store up to MAX_OBJECTS shapes. */
+        for (op = 0; op < 3; op++) {
+            reference[op] = result[op];
+            if (objects == count) {
+                report("objects", ops[op], best[op], objects, objects * 16, result[op], reference[op]);
+            } else {
+                printf("%-7s %-9s %6.2f ns/shape  (first %zu shapes, not checked)\n",
+                       "objects", ops[op], best[op] * 1e9 / objects, objects);
+            }
+        }
+    }
+
+    for (level = SHAPE_SIMD_SCALAR; level <= (int)shape_simd_best(); level++) {
+        const char *name = shape_simd_name(shape_simd_select((enum shape_simd)level));
+        double best[3] = { 1e30, 1e30, 1e30 }, result[3] = { 0, 0, 0 };
+
+        for (round = 0; round < rounds; round++) {
+            struct shape_bounds bounds;
+            double start = now_s(), t;
+
+            result[0] = shape_store_total_area(store);
+            t = now_s() - start;
+            if (t < best[0]) best[0] = t;
+
+            start = now_s();
+            result[1] = shape_store_total_perimeter(store);
+            t = now_s() - start;
+            if (t < best[1]) best[1] = t;
+
+            start = now_s();
+            bounds = shape_store_bounds(store);
+            t = now_s() - start;
+            if (t < best[2]) best[2] = t;
+            result[2] = bounds.max_x;
+        }
+        for (op = 0; op < 3; op++) {
+            if (level == SHAPE_SIMD_SCALAR && objects != count) {
+                reference[op] = result[op];
+            }
+            mismatches += report(name, ops[op], best[op], count, bytes, result[op], reference[op]);
+        }
+    }
+
+    for (i = 0; i < objects; i++) {
+        shape_destroy(shapes[i]);
+    }
+    free(shapes);
+    shape_store_destroy(store);
+    if (mismatches) {
+        fprintf(stderr, "%d results differ by more than %g\n", mismatches, TOLERANCE);
+        return 1;
+    }
+    return 0;
+}
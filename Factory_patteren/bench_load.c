@@ -0,0 +1,234 @@
+/**
+ * @file bench_load.c
+ * @brief Benchmark of loading shapes from a binary file.
+ * @details Writes [count] shapes to [file] as blocks of one type, each a
+ *          header { uint32 type, uint32 count } followed by count groups of
+ *          shape_param_count(type) floats. The file is read back with one
+ *          read() and turned into shapes in four ways:
+ *          - single: a switch on the type and a typed constructor per shape
+ *          - many:   one shape_create_many() per block
+ *          - arena:  one shape_arena_create_many() per block
+ *          - store:  one shape_store_add_many() per block
+ *
+ *          Build: gcc -O2 shape.c shape_store.c shape_kernels.c bench_load.c -o bench_load -lm
+ *          Usage: ./bench_load [count] [file]
+ */
+
+#include "shape.h"
+#include "shape_store.h"
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/** @brief Shapes per block in the generated file. */
+#define BLOCK_SHAPES 1024
+
+/**
+ * @struct block_header
+ * @brief Header in front of each block of the file.
+ */
+struct block_header
+{
+    uint32_t type;   /**< enum shape_type of every shape in the block */
+    uint32_t count;  /**< Shapes in the block */
+};
+
+/**
+ * @brief Monotonic time in seconds.
+ */
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Print one result line.
+ */
+static void report(const char *name, size_t count, double create, double destroy)
+{
+    printf("%-7s create %6.1f ns/shape %7.1f Mshapes/s   destroy %6.1f ns/shape\n",
+           name, create * 1e9 / count, count / create / 1e6, destroy * 1e9 / count);
+}
+
+/**
+ * @brief Write count shapes to path, cycling the type every block.
+ * @return int 1 on success, 0 on failure.
+ */
+static int write_file(const char *path, size_t count)
+{
+    float params[BLOCK_SHAPES * 2];
+    FILE *file = fopen(path, "wb");
+    size_t done = 0;
+    uint32_t type = CIRCLE;
+    size_t i;
+
+    if (!file) return 0;
+    srand(1);
+    while (done < count) {
+        struct block_header header;
+        size_t floats;
+
+        header.type = type;
+        header.count = count - done < BLOCK_SHAPES ? count - done : BLOCK_SHAPES;
+        floats = header.count * shape_param_count(type);
+        for (i = 0; i < floats; i++) {
+            params[i] = 1.0f + rand() % 1000 / 10.0f;
+        }
+        if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+            fwrite(params, sizeof(float), floats, file) != floats) {
+            fclose(file);
+            return 0;
+        }
+        done += header.count;
+        type = (type + 1) % 4;
+    }
+    return fclose(file) == 0;
+}
+
+/**
+ * @brief Read a whole file with one read().
+ * @return Buffer to free, or NULL on failure.
+ */
+static char *read_file(const char *path, size_t *size)
+{
+    struct stat st;
+    char *data;
+    ssize_t got;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) return NULL;
+    if (fstat(fd, &st) < 0 || !(data = malloc(st.st_size ? st.st_size : 1))) {
+        close(fd);
+        return NULL;
+    }
+    got = read(fd, data, st.st_size);
+    close(fd);
+    if (got != st.st_size) {
+        free(data);
+        return NULL;
+    }
+    *size = st.st_size;
+    return data;
+}
+
+/**
+ * @brief Walk the blocks of a loaded file.
+ * @param data File contents.
+ * @param size File size.
+ * @param offset Position of the next block; advanced past it.
+ * @param header Receives the block header.
+ * @return Pointer to the block's parameters, or NULL at the end of the data.
+ */
+static const float *next_block(const char *data, size_t size, size_t *offset, struct block_header *header)
+{
+    const float *params;
+
+    if (size - *offset < sizeof(*header)) return NULL;
+    memcpy(header, data + *offset, sizeof(*header));
+    params = (const float *)(data + *offset + sizeof(*header));
+    *offset += sizeof(*header) + header->count * shape_param_count(header->type) * sizeof(float);
+    return params;
+}
+
+/**
+ * @brief Entry point: generate the file, load it back four ways.
+ */
+int main(int argc, char *argv[])
+{
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    const char *path = argc > 2 ? argv[2] : "/tmp/bench_load.bin";
+    shape_t *shapes = malloc(count * sizeof(shape_t));
+    struct block_header header;
+    struct shape_arena *arena;
+    struct shape_store *store;
+    const float *params;
+    size_t size, offset, done, blocks, i;
+    char *data;
+    double t0, t1, t2;
+
+    if (!count || !shapes) return 1;
+    if (!write_file(path, count)) {
+        perror(path);
+        return 1;
+    }
+    t0 = now_s();
+    data = read_file(path, &size);
+    t1 = now_s();
+    if (!data) {
+        perror(path);
+        return 1;
+    }
+    printf("%zu shapes, %.1f MB file, read in %.1f ms\n", count, size / 1e6, (t1 - t0) * 1e3);
+
+    /* One constructor call per shape, type decided per shape. */
+    t0 = now_s();
+    offset = done = 0;
+    while ((params = next_block(data, size, &offset, &header))) {
+        for (i = 0; i < header.count; i++, done++) {
+            switch (header.type)
+            {
+                case CIRCLE:    shapes[done] = shape_create_circle(params[i]); break;
+                case RECTANGLE: shapes[done] = shape_create_rectangle(params[2 * i], params[2 * i + 1]); break;
+                case TRIANGLE:  shapes[done] = shape_create_triangle(params[2 * i], params[2 * i + 1]); break;
+                case SQUARE:    shapes[done] = shape_create_square(params[i]); break;
+            }
+        }
+    }
+    t1 = now_s();
+    for (i = 0; i < done; i++) {
+        shape_destroy(shapes[i]);
+    }
+    t2 = now_s();
+    report("single", count, t1 - t0, t2 - t1);
+
+    /* One allocation and one fill loop per block. */
+    t0 = now_s();
+    offset = done = blocks = 0;
+    while ((params = next_block(data, size, &offset, &header))) {
+        done += shape_create_many(header.type, params, header.count, shapes + done);
+        blocks++;
+    }
+    t1 = now_s();
+    for (offset = done = 0; next_block(data, size, &offset, &header); done += header.count) {
+        shape_destroy_many(shapes + done, header.count);
+    }
+    t2 = now_s();
+    report("many", count, t1 - t0, t2 - t1);
+
+    /* Same fill loop, memory from arena chunks. */
+    arena = shape_arena_create(0);
+    t0 = now_s();
+    offset = done = 0;
+    while ((params = next_block(data, size, &offset, &header))) {
+        done += shape_arena_create_many(arena, header.type, params, header.count, shapes + done);
+    }
+    t1 = now_s();
+    shape_arena_destroy(arena);
+    t2 = now_s();
+    report("arena", count, t1 - t0, t2 - t1);
+
+    /* No objects at all: the parameters go straight into the buckets. */
+    store = shape_store_create();
+    t0 = now_s();
+    offset = 0;
+    while ((params = next_block(data, size, &offset, &header))) {
+        shape_store_add_many(store, header.type, params, header.count);
+    }
+    t1 = now_s();
+    shape_store_destroy(store);
+    t2 = now_s();
+    report("store", count, t1 - t0, t2 - t1);
+
+    printf("%zu blocks of up to %d shapes\n", blocks, BLOCK_SHAPES);
+    free(data);
+    free(shapes);
+    unlink(path);
+    return 0;
+}
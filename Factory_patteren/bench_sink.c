@@ -0,0 +1,175 @@
+/**
+ * @file bench_sink.c
+ * @brief Benchmark of exporting shapes through printf and through a sink.
+ * @details Creates [count] shapes with random sizes, a quarter of each type,
+ *          and exports them to /dev/null and to [file] in five ways:
+ *          - printf:       shape_draw() per shape, stdout pointed at the target
+ *          - store printf: shape_store_draw() of the same shapes
+ *          - sink text:    shape_sink_draw() per shape, text encoder
+ *          - sink binary:  shape_sink_draw() per shape, binary encoder
+ *          - store text:   shape_sink_draw_store(), text encoder
+ *
+ *          The file is truncated before every run and not synced, so the
+ *          file numbers include the page cache copy but not the disk.
+ *
+ *          Build: gcc -O2 shape.c shape_store.c shape_kernels.c shape_sink.c bench_sink.c -o bench_sink -lm
+ *          Usage: ./bench_sink [count] [file]
+ */
+
+#include "shape.h"
+#include "shape_sink.h"
+#include "shape_store.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/** @brief Shapes per shape_create_many() batch. */
+#define BATCH_SHAPES 1024
+
+/**
+ * @brief Monotonic time in seconds.
+ */
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Open the target for one run, truncating a regular file.
+ */
+static int open_target(const char *path)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror(path);
+        exit(1);
+    }
+    return fd;
+}
+
+/**
+ * @brief Print one result line with the output size.
+ */
+static void report(const char *name, size_t count, double seconds, int fd)
+{
+    struct stat st;
+    off_t bytes = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) ? st.st_size : 0;
+
+    printf("  %-13s %7.1f ns/shape %7.2f Mshapes/s", name, seconds * 1e9 / count, count / seconds / 1e6);
+    if (bytes) {
+        printf("  %6.1f MB", bytes / 1e6);
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Export with printf: point stdout at fd for the duration.
+ */
+static double run_printf(int fd, shape_t *shapes, size_t count, const struct shape_store *store)
+{
+    int saved;
+    double t0, t1;
+    size_t i;
+
+    fflush(stdout);
+    saved = dup(STDOUT_FILENO);
+    dup2(fd, STDOUT_FILENO);
+    t0 = now_s();
+    if (store) {
+        shape_store_draw(store, stdout);
+    } else {
+        for (i = 0; i < count; i++) {
+            shape_draw(shapes[i]);
+        }
+    }
+    fflush(stdout);
+    t1 = now_s();
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    return t1 - t0;
+}
+
+/**
+ * @brief Export through a sink, either the objects or the store.
+ */
+static double run_sink(int fd, enum shape_sink_format format, shape_t *shapes, size_t count,
+                       const struct shape_store *store)
+{
+    struct shape_sink *sink = shape_sink_create(fd, format, 0);
+    double t0 = now_s();
+    size_t i;
+
+    if (store) {
+        shape_sink_draw_store(sink, store);
+    } else {
+        for (i = 0; i < count; i++) {
+            shape_sink_draw(sink, shapes[i]);
+        }
+    }
+    if (shape_sink_destroy(sink)) {
+        fprintf(stderr, "sink write failed\n");
+    }
+    return now_s() - t0;
+}
+
+/**
+ * @brief Entry point: create the shapes, export them to both targets.
+ */
+int main(int argc, char *argv[])
+{
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000000;
+    const char *file = argc > 2 ? argv[2] : "/tmp/bench_sink.out";
+    const char *targets[2] = { "/dev/null", file };
+    shape_t *shapes = malloc(count * sizeof(shape_t));
+    float *params = malloc(BATCH_SHAPES * 2 * sizeof(float));
+    struct shape_store *store = shape_store_create();
+    size_t done, n, i;
+    int target, fd;
+
+    if (!count || !shapes || !params || !store) return 1;
+    srand(1);
+    for (done = 0; done < count; done += n) {
+        enum shape_type type = (enum shape_type)(done / BATCH_SHAPES % 4);
+        n = count - done < BATCH_SHAPES ? count - done : BATCH_SHAPES;
+        for (i = 0; i < n * shape_param_count(type); i++) {
+            params[i] = 1.0f + rand() % 100000 / 100.0f;
+        }
+        shape_create_many(type, params, n, shapes + done);
+        shape_store_add_many(store, type, params, n);
+    }
+    printf("%zu shapes\n", count);
+
+    for (target = 0; target < 2; target++) {
+        printf("%s\n", targets[target]);
+        fd = open_target(targets[target]);
+        report("printf", count, run_printf(fd, shapes, count, NULL), fd);
+        close(fd);
+        fd = open_target(targets[target]);
+        report("store printf", count, run_printf(fd, shapes, count, store), fd);
+        close(fd);
+        fd = open_target(targets[target]);
+        report("sink text", count, run_sink(fd, SHAPE_SINK_TEXT, shapes, count, NULL), fd);
+        close(fd);
+        fd = open_target(targets[target]);
+        report("sink binary", count, run_sink(fd, SHAPE_SINK_BINARY, shapes, count, NULL), fd);
+        close(fd);
+        fd = open_target(targets[target]);
+        report("store text", count, run_sink(fd, SHAPE_SINK_TEXT, shapes, count, store), fd);
+        close(fd);
+    }
+
+    unlink(file);
+    for (done = 0; done < count; done += n) {
+        n = count - done < BATCH_SHAPES ? count - done : BATCH_SHAPES;
+        shape_destroy_many(shapes + done, n);
+    }
+    shape_store_destroy(store);
+    free(params);
+    free(shapes);
+    return 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file bench_store.c
+ * @brief Benchmark of the type-bucketed shape store against shape_draw().
+ * @details Builds [count] shapes of random types twice: as shape_t objects
+ *          from shape_create(), kept in shuffled order like a long-lived
+ *          mixed collection, and in a shape_store. Both are drawn with
+ *          stdout sent to /dev/null:
+ *          - objects: shape_draw() per handle, a vtable call each
+ *          - store:   one shape_store_draw() for the batch
+ *
+ *          Build: gcc -O2 shape.c shape_store.c shape_kernels.c bench_store.c -o bench_store -lm
+ *          Usage: ./bench_store [count] [rounds]
+ */
+
+#include "shape.h"
+#include "shape_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @brief Monotonic time in seconds.
+ */
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 3;
+    shape_t *shapes = malloc(count * sizeof(*shapes));
+    struct shape_store *store = shape_store_create();
+    double start, objects = 0, batch = 0;
+    size_t i;
+    int round;
+
+    if (!shapes || !store) return 1;
+    srand(5);
+    for (i = 0; i < count; i++) {
+        enum shape_type type = (enum shape_type)(rand() & 3);
+        shapes[i] = shape_create(type);
+        /* Same dimensions as the shape_create() defaults. */
+        switch (type)
+        {
+            case CIRCLE:    shape_store_add_circle(store, 10.0f); break;
+            case RECTANGLE: shape_store_add_rectangle(store, 20.0f, 10.0f); break;
+            case TRIANGLE:  shape_store_add_triangle(store, 15.0f, 10.0f); break;
+            case SQUARE:    shape_store_add_square(store, 10.0f); break;
+        }
+    }
+    for (i = count; i > 1; i--) {
+        size_t j = (size_t)rand() % i;
+        shape_t t = shapes[i - 1];
+        shapes[i - 1] = shapes[j];
+        shapes[j] = t;
+    }
+
+    fprintf(stderr, "%zu shapes, %d rounds, drawing to /dev/null\n", count, rounds);
+    if (!freopen("/dev/null", "w", stdout)) return 1;
+    for (round = 0; round < rounds; round++) {
+        start = now_s();
+        for (i = 0; i < count; i++) {
+            shape_draw(shapes[i]);
+        }
+        fflush(stdout);
+        objects += now_s() - start;
+
+        start = now_s();
+        shape_store_draw(store, stdout);
+        fflush(stdout);
+        batch += now_s() - start;
+    }
+    fprintf(stderr, "objects  %6.1f ns/shape\n", objects * 1e9 / ((double)count * rounds));
+    fprintf(stderr, "store    %6.1f ns/shape\n", batch * 1e9 / ((double)count * rounds));
+
+    for (i = 0; i < count; i++) {
+        shape_destroy(shapes[i]);
+    }
+    free(shapes);
+    shape_store_destroy(store);
+    return 0;
+}
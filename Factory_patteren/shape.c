@@ -9,6 +9,7 @@
  */
 
 #include "shape.h"
+#include <math.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -116,6 +117,184 @@ static void shape_square_draw(shape_t shape)
     printf("Drawing square with side: %.2f\n", self->side);
 }
 
+/**
+ * @brief Parameters of a circle: radius.
+ * @param shape Opaque handle to the circle shape.
+ * @param params Receives the radius.
+ */
+static enum shape_type shape_circle_params(shape_t shape, float *params)
+{
+    struct shape_circle *self = CONTAINER_OF(shape, struct shape_circle, shape.method);
+    params[0] = self->radius;
+    return CIRCLE;
+}
+
+/**
+ * @brief Parameters of a rectangle: width, height.
+ * @param shape Opaque handle to the rectangle shape.
+ * @param params Receives width and height.
+ */
+static enum shape_type shape_rectangle_params(shape_t shape, float *params)
+{
+    struct shape_rectangle *self = CONTAINER_OF(shape, struct shape_rectangle, shape.method);
+    params[0] = self->width;
+    params[1] = self->height;
+    return RECTANGLE;
+}
+
+/**
+ * @brief Parameters of a triangle: base, height.
+ * @param shape Opaque handle to the triangle shape.
+ * @param params Receives base and height.
+ */
+static enum shape_type shape_triangle_params(shape_t shape, float *params)
+{
+    struct shape_triangle *self = CONTAINER_OF(shape, struct shape_triangle, shape.method);
+    params[0] = self->base;
+    params[1] = self->height;
+    return TRIANGLE;
+}
+
+/**
+ * @brief Parameters of a square: side.
+ * @param shape Opaque handle to the square shape.
+ * @param params Receives the side length.
+ */
+static enum shape_type shape_square_params(shape_t shape, float *params)
+{
+    struct shape_square *self = CONTAINER_OF(shape, struct shape_square, shape.method);
+    params[0] = self->side;
+    return SQUARE;
+}
+
+/* ============================================================================
+ * Shape Geometry Implementations
+ * ============================================================================ */
+
+/** @brief Pi as a float. */
+#define SHAPE_PI 3.14159265358979323846f
+
+/**
+ * @brief Area of a circle.
+ * @param shape Opaque handle to the circle shape.
+ */
+static float shape_circle_area(shape_t shape)
+{
+    struct shape_circle *self = CONTAINER_OF(shape, struct shape_circle, shape.method);
+    return SHAPE_PI * self->radius * self->radius;
+}
+
+/**
+ * @brief Perimeter (circumference) of a circle.
+ * @param shape Opaque handle to the circle shape.
+ */
+static float shape_circle_perimeter(shape_t shape)
+{
+    struct shape_circle *self = CONTAINER_OF(shape, struct shape_circle, shape.method);
+    return 2.0f * SHAPE_PI * self->radius;
+}
+
+/**
+ * @brief Bounds of a circle centered on the origin.
+ * @param shape Opaque handle to the circle shape.
+ */
+static struct shape_bounds shape_circle_bounds(shape_t shape)
+{
+    struct shape_circle *self = CONTAINER_OF(shape, struct shape_circle, shape.method);
+    return (struct shape_bounds){ -self->radius, -self->radius, self->radius, self->radius };
+}
+
+/**
+ * @brief Area of a rectangle.
+ * @param shape Opaque handle to the rectangle shape.
+ */
+static float shape_rectangle_area(shape_t shape)
+{
+    struct shape_rectangle *self = CONTAINER_OF(shape, struct shape_rectangle, shape.method);
+    return self->width * self->height;
+}
+
+/**
+ * @brief Perimeter of a rectangle.
+ * @param shape Opaque handle to the rectangle shape.
+ */
+static float shape_rectangle_perimeter(shape_t shape)
+{
+    struct shape_rectangle *self = CONTAINER_OF(shape, struct shape_rectangle, shape.method);
+    return 2.0f * (self->width + self->height);
+}
+
+/**
+ * @brief Bounds of a rectangle with its lower left corner on the origin.
+ * @param shape Opaque handle to the rectangle shape.
+ */
+static struct shape_bounds shape_rectangle_bounds(shape_t shape)
+{
+    struct shape_rectangle *self = CONTAINER_OF(shape, struct shape_rectangle, shape.method);
+    return (struct shape_bounds){ 0.0f, 0.0f, self->width, self->height };
+}
+
+/**
+ * @brief Area of a triangle.
+ * @param shape Opaque handle to the triangle shape.
+ */
+static float shape_triangle_area(shape_t shape)
+{
+    struct shape_triangle *self = CONTAINER_OF(shape, struct shape_triangle, shape.method);
+    return 0.5f * self->base * self->height;
+}
+
+/**
+ * @brief Perimeter of an isosceles triangle.
+ * @param shape Opaque handle to the triangle shape.
+ */
+static float shape_triangle_perimeter(shape_t shape)
+{
+    struct shape_triangle *self = CONTAINER_OF(shape, struct shape_triangle, shape.method);
+    float half = 0.5f * self->base;
+    return self->base + 2.0f * sqrtf(half * half + self->height * self->height);
+}
+
+/**
+ * @brief Bounds of a triangle with its base on the x axis from the origin.
+ * @param shape Opaque handle to the triangle shape.
+ */
+static struct shape_bounds shape_triangle_bounds(shape_t shape)
+{
+    struct shape_triangle *self = CONTAINER_OF(shape, struct shape_triangle, shape.method);
+    return (struct shape_bounds){ 0.0f, 0.0f, self->base, self->height };
+}
+
+/**
+ * @brief Area of a square.
+ * @param shape Opaque handle to the square shape.
+ */
+static float shape_square_area(shape_t shape)
+{
+    struct shape_square *self = CONTAINER_OF(shape, struct shape_square, shape.method);
+    return self->side * self->side;
+}
+
+/**
+ * @brief Perimeter of a square.
+ * @param shape Opaque handle to the square shape.
+ */
+static float shape_square_perimeter(shape_t shape)
+{
+    struct shape_square *self = CONTAINER_OF(shape, struct shape_square, shape.method);
+    return 4.0f * self->side;
+}
+
+/**
+ * @brief Bounds of a square with its lower left corner on the origin.
+ * @param shape Opaque handle to the square shape.
+ */
+static struct shape_bounds shape_square_bounds(shape_t shape)
+{
+    struct shape_square *self = CONTAINER_OF(shape, struct shape_square, shape.method);
+    return (struct shape_bounds){ 0.0f, 0.0f, self->side, self->side };
+}
+
 /* ============================================================================
  * Static Virtual Method Tables (vtables)
  * ============================================================================ */
@@ -123,21 +302,37 @@ static void shape_square_draw(shape_t shape)
 /** @brief Virtual method table for circle operations. */
 static const struct shape_method circle_method = {
     .draw = shape_circle_draw,
+    .params = shape_circle_params,
+    .area = shape_circle_area,
+    .perimeter = shape_circle_perimeter,
+    .bounds = shape_circle_bounds,
 };
 
 /** @brief Virtual method table for rectangle operations. */
 static const struct shape_method rectangle_method = {
     .draw = shape_rectangle_draw,
+    .params = shape_rectangle_params,
+    .area = shape_rectangle_area,
+    .perimeter = shape_rectangle_perimeter,
+    .bounds = shape_rectangle_bounds,
 };
 
 /** @brief Virtual method table for triangle operations. */
 static const struct shape_method triangle_method = {
     .draw = shape_triangle_draw,
+    .params = shape_triangle_params,
+    .area = shape_triangle_area,
+    .perimeter = shape_triangle_perimeter,
+    .bounds = shape_triangle_bounds,
 };
 
 /** @brief Virtual method table for square operations. */
 static const struct shape_method square_method = {
     .draw = shape_square_draw,
+    .params = shape_square_params,
+    .area = shape_square_area,
+    .perimeter = shape_square_perimeter,
+    .bounds = shape_square_bounds,
 };
 
 /* ============================================================================
@@ -155,79 +350,445 @@ void shape_draw(shape_t shape)
     }
 }
 
+/**
+ * @brief Type and parameters of any shape.
+ * @param shape Opaque handle to the shape object.
+ * @param type Receives the type.
+ * @param params Receives up to two parameters.
+ */
+int shape_get_params(shape_t shape, enum shape_type *type, float params[2])
+{
+    if (shape && *shape && (*shape)->params) {
+        *type = (*shape)->params(shape, params);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Area of any shape.
+ * @param shape Opaque handle to the shape object.
+ */
+float shape_area(shape_t shape)
+{
+    if (shape && *shape && (*shape)->area) {
+        return (*shape)->area(shape);
+    }
+    return 0.0f;
+}
+
+/**
+ * @brief Perimeter of any shape.
+ * @param shape Opaque handle to the shape object.
+ */
+float shape_perimeter(shape_t shape)
+{
+    if (shape && *shape && (*shape)->perimeter) {
+        return (*shape)->perimeter(shape);
+    }
+    return 0.0f;
+}
+
+/**
+ * @brief Bounding box of any shape.
+ * @param shape Opaque handle to the shape object.
+ */
+struct shape_bounds shape_get_bounds(shape_t shape)
+{
+    if (shape && *shape && (*shape)->bounds) {
+        return (*shape)->bounds(shape);
+    }
+    return (struct shape_bounds){ 0.0f, 0.0f, 0.0f, 0.0f };
+}
+
+/* ============================================================================
+ * Shape Initialization
+ * ============================================================================ */
+
+/**
+ * @brief Initialize n circles in consecutive memory.
+ * @param memory Room for n struct shape_circle.
+ * @param params n radii.
+ * @param n Number of circles.
+ * @param out Receives the n handles.
+ */
+static void shape_circles_init(void *memory, const float *params, size_t n, shape_t *out)
+{
+    struct shape_circle *circle = memory;
+    size_t i;
+
+    for (i = 0; i < n; i++, circle++) {
+        *circle = (struct shape_circle){
+            .shape.method = &circle_method,
+            .radius = params[i]
+        };
+        out[i] = (shape_t)&circle->shape.method;
+    }
+}
+
+/**
+ * @brief Initialize n rectangles in consecutive memory.
+ * @param memory Room for n struct shape_rectangle.
+ * @param params n width, height pairs.
+ * @param n Number of rectangles.
+ * @param out Receives the n handles.
+ */
+static void shape_rectangles_init(void *memory, const float *params, size_t n, shape_t *out)
+{
+    struct shape_rectangle *rectangle = memory;
+    size_t i;
+
+    for (i = 0; i < n; i++, rectangle++) {
+        *rectangle = (struct shape_rectangle){
+            .shape.method = &rectangle_method,
+            .width = params[2 * i],
+            .height = params[2 * i + 1]
+        };
+        out[i] = (shape_t)&rectangle->shape.method;
+    }
+}
+
+/**
+ * @brief Initialize n triangles in consecutive memory.
+ * @param memory Room for n struct shape_triangle.
+ * @param params n base, height pairs.
+ * @param n Number of triangles.
+ * @param out Receives the n handles.
+ */
+static void shape_triangles_init(void *memory, const float *params, size_t n, shape_t *out)
+{
+    struct shape_triangle *triangle = memory;
+    size_t i;
+
+    for (i = 0; i < n; i++, triangle++) {
+        *triangle = (struct shape_triangle){
+            .shape.method = &triangle_method,
+            .base = params[2 * i],
+            .height = params[2 * i + 1]
+        };
+        out[i] = (shape_t)&triangle->shape.method;
+    }
+}
+
+/**
+ * @brief Initialize n squares in consecutive memory.
+ * @param memory Room for n struct shape_square.
+ * @param params n side lengths.
+ * @param n Number of squares.
+ * @param out Receives the n handles.
+ */
+static void shape_squares_init(void *memory, const float *params, size_t n, shape_t *out)
+{
+    struct shape_square *square = memory;
+    size_t i;
+
+    for (i = 0; i < n; i++, square++) {
+        *square = (struct shape_square){
+            .shape.method = &square_method,
+            .side = params[i]
+        };
+        out[i] = (shape_t)&square->shape.method;
+    }
+}
+
+/**
+ * @struct shape_class
+ * @brief What the factory needs to know about a shape type.
+ */
+struct shape_class
+{
+    size_t size;                /**< Size of the concrete structure */
+    size_t params;              /**< Floats per shape in a parameter buffer */
+    float defaults[2];          /**< Parameters used by shape_create() */
+    void (*init)(void *memory, const float *params, size_t n, shape_t *out);  /**< Batch initializer */
+};
+
+/** @brief Factory data per shape type, indexed by enum shape_type. */
+static const struct shape_class shape_classes[] = {
+    [CIRCLE]    = { sizeof(struct shape_circle),    1, { 10.0f },        shape_circles_init },
+    [RECTANGLE] = { sizeof(struct shape_rectangle), 2, { 20.0f, 10.0f }, shape_rectangles_init },
+    [TRIANGLE]  = { sizeof(struct shape_triangle),  2, { 15.0f, 10.0f }, shape_triangles_init },
+    [SQUARE]    = { sizeof(struct shape_square),    1, { 10.0f },        shape_squares_init },
+};
+
+/**
+ * @brief Look up the factory data for a type.
+ * @param type The type of shape.
+ * @return Pointer to the class, or NULL for an unknown type.
+ */
+static const struct shape_class *shape_class_of(enum shape_type type)
+{
+    if ((unsigned)type >= sizeof(shape_classes) / sizeof(shape_classes[0])) return NULL;
+    return &shape_classes[type];
+}
+
+/**
+ * @brief Allocate and initialize one shape.
+ * @param type The type of shape to create.
+ * @param params The shape's parameters.
+ * @return shape_t Handle to the created shape, or NULL on failure.
+ */
+static shape_t shape_new(enum shape_type type, const float *params)
+{
+    const struct shape_class *class = shape_class_of(type);
+    shape_t shape;
+    void *memory;
+
+    if (!class) return NULL;
+    memory = malloc(class->size);
+    if (!memory) return NULL;
+    class->init(memory, params, 1, &shape);
+    return shape;
+}
+
 /**
  * @brief Unified factory function to create shape objects.
- * @details Optimized with compound literals for initialization.
  * @param type The type of shape to create.
  * @return shape_t Handle to the created shape, or NULL on failure.
  */
 shape_t shape_create(enum shape_type type)
 {
-    switch (type)
-    {
-        case CIRCLE:
-        {
-            struct shape_circle *circle = malloc(sizeof(*circle));
-            if (!circle) return NULL;
-            
-            *circle = (struct shape_circle){
-                .shape.method = &circle_method,
-                .radius = 10.0f
-            };
-            return (shape_t)&circle->shape.method;
-        }
-        
-        case RECTANGLE:
-        {
-            struct shape_rectangle *rectangle = malloc(sizeof(*rectangle));
-            if (!rectangle) return NULL;
-            
-            *rectangle = (struct shape_rectangle){
-                .shape.method = &rectangle_method,
-                .width = 20.0f,
-                .height = 10.0f
-            };
-            return (shape_t)&rectangle->shape.method;
-        }
-        
-        case TRIANGLE:
-        {
-            struct shape_triangle *triangle = malloc(sizeof(*triangle));
-            if (!triangle) return NULL;
-            
-            *triangle = (struct shape_triangle){
-                .shape.method = &triangle_method,
-                .base = 15.0f,
-                .height = 10.0f
-            };
-            return (shape_t)&triangle->shape.method;
-        }
-        
-        case SQUARE:
-        {
-            struct shape_square *square = malloc(sizeof(*square));
-            if (!square) return NULL;
-            
-            *square = (struct shape_square){
-                .shape.method = &square_method,
-                .side = 10.0f
-            };
-            return (shape_t)&square->shape.method;
-        }
-        
-        default:
-            return NULL;
+    const struct shape_class *class = shape_class_of(type);
+    return class ? shape_new(type, class->defaults) : NULL;
+}
+
+/**
+ * @brief Create a circle with the given radius.
+ */
+shape_t shape_create_circle(float radius)
+{
+    return shape_new(CIRCLE, &radius);
+}
+
+/**
+ * @brief Create a rectangle with the given size.
+ */
+shape_t shape_create_rectangle(float width, float height)
+{
+    const float params[2] = { width, height };
+    return shape_new(RECTANGLE, params);
+}
+
+/**
+ * @brief Create a triangle with the given base and height.
+ */
+shape_t shape_create_triangle(float base, float height)
+{
+    const float params[2] = { base, height };
+    return shape_new(TRIANGLE, params);
+}
+
+/**
+ * @brief Create a square with the given side length.
+ */
+shape_t shape_create_square(float side)
+{
+    return shape_new(SQUARE, &side);
+}
+
+/**
+ * @brief Parameters per shape in a bulk parameter buffer.
+ */
+size_t shape_param_count(enum shape_type type)
+{
+    const struct shape_class *class = shape_class_of(type);
+    return class ? class->params : 0;
+}
+
+/**
+ * @brief Create n shapes of one type in a single allocation.
+ * @details The type is looked up once and the shapes are laid out back to
+ *          back, so the loop is a sequential fill without a branch on the
+ *          type.
+ */
+size_t shape_create_many(enum shape_type type, const float *params, size_t n, shape_t *out)
+{
+    const struct shape_class *class = shape_class_of(type);
+    void *memory;
+
+    if (!class || !n || n > (size_t)-1 / class->size) return 0;
+    memory = malloc(n * class->size);
+    if (!memory) return 0;
+    class->init(memory, params, n, out);
+    return n;
+}
+
+/**
+ * @brief Free shapes made by one shape_create_many() call.
+ * @details The first handle is the start of the shared allocation.
+ */
+void shape_destroy_many(shape_t *shapes, size_t n)
+{
+    if (shapes && n) {
+        free(CONTAINER_OF(shapes[0], struct shape, method));
     }
 }
 
 /**
  * @brief Destroy and free a shape object.
+ * @details The handle points at the method member, which is the first
+ *          member of the allocation.
  * @param shape Handle to the shape object to destroy.
  */
 void shape_destroy(shape_t shape)
 {
     if (shape && *shape) {
-        struct shape *base = CONTAINER_OF(*shape, struct shape, method);
+        struct shape *base = CONTAINER_OF(shape, struct shape, method);
         free(base);
     }
-}
\ No newline at end of file
+}
+
+/* ============================================================================
+ * Shape Arena Implementation
+ * ============================================================================ */
+
+/**
+ * @def SHAPE_ARENA_ALIGN
+ * @brief Alignment of every shape in an arena (that of the vtable pointer).
+ */
+#define SHAPE_ARENA_ALIGN (sizeof(void *))
+
+/**
+ * @struct shape_arena_chunk
+ * @brief One block of arena memory; shapes follow the header.
+ */
+struct shape_arena_chunk
+{
+    struct shape_arena_chunk *next;  /**< Previously filled chunk */
+    size_t size;                     /**< Usable bytes after the header */
+};
+
+/**
+ * @struct shape_arena
+ * @brief Chain of chunks with a bump pointer into the newest one.
+ */
+struct shape_arena
+{
+    struct shape_arena_chunk *chunks;  /**< Newest chunk first */
+    char *next;                        /**< Next free byte in the newest chunk */
+    char *end;                         /**< End of the newest chunk */
+    size_t chunk_size;                 /**< Usable bytes per new chunk */
+};
+
+/**
+ * @brief Start a new chunk.
+ * @param arena Arena to grow.
+ * @param min_size Bytes the chunk must hold at least.
+ * @return 1 on success, 0 if out of memory.
+ */
+static int shape_arena_grow(struct shape_arena *arena, size_t min_size)
+{
+    size_t size = min_size > arena->chunk_size ? min_size : arena->chunk_size;
+    struct shape_arena_chunk *chunk;
+
+    if (size > (size_t)-1 - sizeof(*chunk)) return 0;
+    chunk = malloc(sizeof(*chunk) + size);
+    if (!chunk) return 0;
+
+    chunk->next = arena->chunks;
+    chunk->size = size;
+    arena->chunks = chunk;
+    arena->next = (char *)(chunk + 1);
+    arena->end = arena->next + chunk->size;
+    return 1;
+}
+
+/**
+ * @brief Create an empty arena; no chunk is allocated until the first shape.
+ * @param chunk_size Bytes per chunk, or 0 for the default.
+ * @return Pointer to the arena, or NULL on failure.
+ */
+struct shape_arena *shape_arena_create(size_t chunk_size)
+{
+    struct shape_arena *arena = malloc(sizeof(*arena));
+    if (!arena) return NULL;
+
+    /* Every chunk must hold at least one shape of the largest type. */
+    if (chunk_size < sizeof(struct shape_rectangle)) {
+        chunk_size = chunk_size ? sizeof(struct shape_rectangle) : SHAPE_ARENA_DEFAULT_CHUNK;
+    }
+    *arena = (struct shape_arena){
+        .chunk_size = chunk_size
+    };
+    return arena;
+}
+
+/**
+ * @brief Bump-allocate and initialize a shape in the arena.
+ * @param arena Arena to allocate from.
+ * @param type The type of shape to create.
+ * @return shape_t Handle to the shape, or NULL on failure.
+ */
+shape_t shape_arena_create_shape(struct shape_arena *arena, enum shape_type type)
+{
+    const struct shape_class *class = shape_class_of(type);
+    shape_t shape;
+
+    if (!class || !shape_arena_create_many(arena, type, class->defaults, 1, &shape)) return NULL;
+    return shape;
+}
+
+/**
+ * @brief Bump-allocate n shapes of one type back to back.
+ * @details A batch never spans chunks; one larger than the chunk size
+ *          gets a chunk of its own.
+ * @param arena Arena to allocate from.
+ * @param type The type of shape to create.
+ * @param params shape_param_count(type) floats per shape.
+ * @param n Number of shapes.
+ * @param out Receives the n handles.
+ * @return size_t n on success, 0 on failure.
+ */
+size_t shape_arena_create_many(struct shape_arena *arena, enum shape_type type,
+                               const float *params, size_t n, shape_t *out)
+{
+    const struct shape_class *class = shape_class_of(type);
+    size_t size;
+
+    if (!arena || !class || !n || n > ((size_t)-1 - SHAPE_ARENA_ALIGN) / class->size) return 0;
+    size = (n * class->size + SHAPE_ARENA_ALIGN - 1) & ~(SHAPE_ARENA_ALIGN - 1);
+    if ((size_t)(arena->end - arena->next) < size && !shape_arena_grow(arena, size)) {
+        return 0;
+    }
+    class->init(arena->next, params, n, out);
+    arena->next += size;
+    return n;
+}
+
+/**
+ * @brief Drop every shape, keeping the first chunk for the next batch.
+ * @param arena Arena to reset.
+ */
+void shape_arena_reset(struct shape_arena *arena)
+{
+    struct shape_arena_chunk *chunk;
+
+    if (!arena || !arena->chunks) return;
+
+    /* Keep the oldest chunk, the only one at the end of the chain. */
+    while (arena->chunks->next) {
+        chunk = arena->chunks;
+        arena->chunks = chunk->next;
+        free(chunk);
+    }
+    arena->next = (char *)(arena->chunks + 1);
+    arena->end = arena->next + arena->chunks->size;
+}
+
+/**
+ * @brief Free every chunk and the arena.
+ * @param arena Arena to destroy.
+ */
+void shape_arena_destroy(struct shape_arena *arena)
+{
+    struct shape_arena_chunk *chunk;
+
+    if (!arena) return;
+
+    while (arena->chunks) {
+        chunk = arena->chunks;
+        arena->chunks = chunk->next;
+        free(chunk);
+    }
+    free(arena);
+}
@@ -12,6 +12,8 @@
 #ifndef SHAPE_H
 #define SHAPE_H
 
+#include <stddef.h>
+
 /**
  * @enum shape_type
  * @brief Enumeration of available shape types.
@@ -34,6 +36,20 @@ enum shape_type
  */
 typedef struct shape_method ** shape_t;
 
+/**
+ * @struct shape_bounds
+ * @brief Axis-aligned bounding box.
+ * @details Shapes have no position: a circle is centered on the origin,
+ *          every other shape has its lower left corner on it.
+ */
+struct shape_bounds
+{
+    float min_x;  /**< Left edge */
+    float min_y;  /**< Bottom edge */
+    float max_x;  /**< Right edge */
+    float max_y;  /**< Top edge */
+};
+
 /**
  * @struct shape_method
  * @brief Virtual function table (vtable) for shape operations.
@@ -47,6 +63,35 @@ struct shape_method
      * @param shape Handle to the shape object to be drawn.
      */
     void (*draw)(shape_t shape);
+
+    /**
+     * @brief Function pointer to read the shape's parameters.
+     * @param shape Handle to the shape object.
+     * @param params Receives shape_param_count() floats.
+     * @return enum shape_type Type of the shape.
+     */
+    enum shape_type (*params)(shape_t shape, float *params);
+
+    /**
+     * @brief Function pointer to compute the shape's area.
+     * @param shape Handle to the shape object.
+     * @return float Area of the shape.
+     */
+    float (*area)(shape_t shape);
+
+    /**
+     * @brief Function pointer to compute the shape's perimeter.
+     * @param shape Handle to the shape object.
+     * @return float Perimeter of the shape.
+     */
+    float (*perimeter)(shape_t shape);
+
+    /**
+     * @brief Function pointer to compute the shape's bounding box.
+     * @param shape Handle to the shape object.
+     * @return struct shape_bounds Bounds of the shape.
+     */
+    struct shape_bounds (*bounds)(shape_t shape);
 };
 
 /**
@@ -71,6 +116,59 @@ struct shape
  */
 shape_t shape_create(enum shape_type type);
 
+/**
+ * @brief Create a circle with the given radius.
+ * @return shape_t Handle to free with shape_destroy(), or NULL on failure.
+ */
+shape_t shape_create_circle(float radius);
+
+/**
+ * @brief Create a rectangle with the given width and height.
+ * @return shape_t Handle to free with shape_destroy(), or NULL on failure.
+ */
+shape_t shape_create_rectangle(float width, float height);
+
+/**
+ * @brief Create a triangle with the given base and height.
+ * @return shape_t Handle to free with shape_destroy(), or NULL on failure.
+ */
+shape_t shape_create_triangle(float base, float height);
+
+/**
+ * @brief Create a square with the given side length.
+ * @return shape_t Handle to free with shape_destroy(), or NULL on failure.
+ */
+shape_t shape_create_square(float side);
+
+/**
+ * @brief Number of floats per shape in a bulk parameter buffer.
+ * @details CIRCLE: radius. RECTANGLE: width, height. TRIANGLE: base, height.
+ *          SQUARE: side.
+ * @param type The type of shape.
+ * @return size_t 1 or 2, or 0 for an unknown type.
+ */
+size_t shape_param_count(enum shape_type type);
+
+/**
+ * @brief Create n shapes of one type from a parameter buffer.
+ * @details All n shapes share one allocation and are filled in a single pass,
+ *          in the order of the buffer.
+ * @param type The type of the shapes.
+ * @param params n * shape_param_count(type) floats, one group per shape.
+ * @param n Number of shapes to create.
+ * @param out Receives the n handles.
+ * @return size_t n on success, 0 on failure (nothing is allocated).
+ * @warning Release the batch with shape_destroy_many(), never shape_destroy().
+ */
+size_t shape_create_many(enum shape_type type, const float *params, size_t n, shape_t *out);
+
+/**
+ * @brief Free a batch made by shape_create_many().
+ * @param shapes The handles filled in by shape_create_many(), unmodified.
+ * @param n Number of shapes in the batch.
+ */
+void shape_destroy_many(shape_t *shapes, size_t n);
+
 /**
  * @brief Draw the specified shape.
  * @details Calls the appropriate draw implementation based on the shape's type.
@@ -80,6 +178,39 @@ shape_t shape_create(enum shape_type type);
  */
 void shape_draw(shape_t shape);
 
+/**
+ * @brief Type and parameters of the specified shape.
+ * @details Parameters come in the order of shape_create_many(), so they can
+ *          be written out and used to recreate the shape.
+ * @param shape Handle to the shape object.
+ * @param type Receives the type.
+ * @param params Receives shape_param_count() floats, at most 2.
+ * @return int 1 on success, 0 if shape is NULL.
+ */
+int shape_get_params(shape_t shape, enum shape_type *type, float params[2]);
+
+/**
+ * @brief Area of the specified shape.
+ * @param shape Handle to the shape object.
+ * @return float Area, or 0 if shape is NULL.
+ */
+float shape_area(shape_t shape);
+
+/**
+ * @brief Perimeter of the specified shape.
+ * @details Triangles are isosceles: the apex is above the middle of the base.
+ * @param shape Handle to the shape object.
+ * @return float Perimeter, or 0 if shape is NULL.
+ */
+float shape_perimeter(shape_t shape);
+
+/**
+ * @brief Axis-aligned bounding box of the specified shape.
+ * @param shape Handle to the shape object.
+ * @return struct shape_bounds Bounds, all zero if shape is NULL.
+ */
+struct shape_bounds shape_get_bounds(shape_t shape);
+
 /**
  * @brief Destroy and free a shape object.
  * @details Frees the memory allocated for the shape object.
@@ -87,4 +218,65 @@ void shape_draw(shape_t shape);
  */
 void shape_destroy(shape_t shape);
 
+/* ============================================================================
+ * Shape Arena
+ * ============================================================================ */
+
+/**
+ * @struct shape_arena
+ * @brief Opaque arena that shapes created and dropped together live in.
+ * @details Shapes are bump-allocated from large chunks, so creating one is a
+ *          pointer increment and the whole set is released with a single
+ *          shape_arena_destroy() or shape_arena_reset().
+ */
+struct shape_arena;
+
+/** @brief Default chunk size of a shape arena (1 MiB). */
+#define SHAPE_ARENA_DEFAULT_CHUNK (1u << 20)
+
+/**
+ * @brief Create an empty shape arena.
+ * @param chunk_size Bytes per chunk, or 0 for SHAPE_ARENA_DEFAULT_CHUNK.
+ * @return Pointer to the arena, or NULL on failure.
+ */
+struct shape_arena *shape_arena_create(size_t chunk_size);
+
+/**
+ * @brief Create a shape inside an arena.
+ * @details Same shape and defaults as shape_create(); the returned handle
+ *          works with every shape function except shape_destroy().
+ * @param arena Arena to allocate from.
+ * @param type The type of shape to create.
+ * @return shape_t Handle valid until the arena is reset or destroyed, or NULL on failure.
+ * @warning Never pass these handles to shape_destroy().
+ */
+shape_t shape_arena_create_shape(struct shape_arena *arena, enum shape_type type);
+
+/**
+ * @brief Create n shapes of one type inside an arena from a parameter buffer.
+ * @details Parameters are laid out as for shape_create_many(); the shapes are
+ *          placed back to back in one chunk.
+ * @param arena Arena to allocate from.
+ * @param type The type of the shapes.
+ * @param params n * shape_param_count(type) floats.
+ * @param n Number of shapes to create.
+ * @param out Receives the n handles.
+ * @return size_t n on success, 0 on failure.
+ * @warning Never pass these handles to shape_destroy().
+ */
+size_t shape_arena_create_many(struct shape_arena *arena, enum shape_type type,
+                               const float *params, size_t n, shape_t *out);
+
+/**
+ * @brief Release every shape in the arena but keep its first chunk for reuse.
+ * @param arena Arena to reset.
+ */
+void shape_arena_reset(struct shape_arena *arena);
+
+/**
+ * @brief Release every shape in the arena and the arena itself.
+ * @param arena Arena to destroy (NULL is ignored).
+ */
+void shape_arena_destroy(struct shape_arena *arena);
+
 #endif // SHAPE_H
\ No newline at end of file
@@ -0,0 +1,428 @@
+/**
+ * @file shape_kernels.c
+ * @brief Scalar, SSE and AVX2 reductions over float arrays.
+ * @details The vector versions keep two accumulators to hide the latency of
+ *          the adds and use unaligned loads, so the store's arrays need no
+ *          special alignment. The AVX2 functions are compiled for that
+ *          target only; they are called once the CPU has been checked.
+ * @author Your Name
+ * @date December 8, 2025
+ * @version 1.0
+ */
+
+#include "shape_kernels.h"
+#include <math.h>
+
+#if defined(__x86_64__)
+#define SHAPE_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+/** @brief Elements summed in float lanes before the block is added to a double. */
+#define SHAPE_KERNEL_BLOCK 4096
+
+/**
+ * @struct shape_kernel_table
+ * @brief One implementation of every kernel.
+ */
+struct shape_kernel_table
+{
+    enum shape_simd level;                                                        /**< Instruction set */
+    double (*sum)(const float *a, size_t n);                                      /**< shape_kernel_sum() */
+    double (*dot)(const float *a, const float *b, size_t n);                      /**< shape_kernel_dot() */
+    double (*triangle_perimeters)(const float *base, const float *height, size_t n); /**< shape_kernel_triangle_perimeters() */
+    float (*max)(const float *a, size_t n);                                       /**< shape_kernel_max() */
+};
+
+/* ============================================================================
+ * Scalar Kernels
+ * ============================================================================ */
+
+/** @brief Scalar shape_kernel_sum(), accumulating in double. */
+static double scalar_sum(const float *a, size_t n)
+{
+    double total = 0.0;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        total += a[i];
+    }
+    return total;
+}
+
+/** @brief Scalar shape_kernel_dot(). */
+static double scalar_dot(const float *a, const float *b, size_t n)
+{
+    double total = 0.0;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+/** @brief Scalar shape_kernel_triangle_perimeters(). */
+static double scalar_triangle_perimeters(const float *base, const float *height, size_t n)
+{
+    double total = 0.0;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        float half = 0.5f * base[i];
+        total += base[i] + 2.0f * sqrtf(half * half + height[i] * height[i]);
+    }
+    return total;
+}
+
+/** @brief Scalar shape_kernel_max(). */
+static float scalar_max(const float *a, size_t n)
+{
+    float max = -INFINITY;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        if (a[i] > max) max = a[i];
+    }
+    return max;
+}
+
+/** @brief Plain C kernels, available everywhere. */
+static const struct shape_kernel_table scalar_kernels = {
+    .level = SHAPE_SIMD_SCALAR,
+    .sum = scalar_sum,
+    .dot = scalar_dot,
+    .triangle_perimeters = scalar_triangle_perimeters,
+    .max = scalar_max,
+};
+
+#ifdef SHAPE_KERNELS_X86
+
+/* ============================================================================
+ * SSE Kernels (4 lanes, always available on x86-64)
+ * ============================================================================ */
+
+/** @brief Sum of the four lanes. */
+static inline float sse_hsum(__m128 v)
+{
+    __m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+
+/** @brief Largest of the four lanes. */
+static inline float sse_hmax(__m128 v)
+{
+    __m128 m = _mm_max_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_max_ss(m, _mm_shuffle_ps(m, m, 1)));
+}
+
+/** @brief End of the block starting at i. */
+static inline size_t block_end(size_t i, size_t n)
+{
+    return n - i > SHAPE_KERNEL_BLOCK ? i + SHAPE_KERNEL_BLOCK : n;
+}
+
+/** @brief SSE shape_kernel_sum(). */
+static double sse_sum(const float *a, size_t n)
+{
+    double total = 0.0;
+    size_t i = 0;
+
+    while (n - i >= 4) {
+        size_t end = block_end(i, n);
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+
+        for (; i + 8 <= end; i += 8) {
+            acc0 = _mm_add_ps(acc0, _mm_loadu_ps(a + i));
+            acc1 = _mm_add_ps(acc1, _mm_loadu_ps(a + i + 4));
+        }
+        for (; i + 4 <= end; i += 4) {
+            acc0 = _mm_add_ps(acc0, _mm_loadu_ps(a + i));
+        }
+        total += sse_hsum(_mm_add_ps(acc0, acc1));
+    }
+    return total + scalar_sum(a + i, n - i);
+}
+
+/** @brief SSE shape_kernel_dot(). */
+static double sse_dot(const float *a, const float *b, size_t n)
+{
+    double total = 0.0;
+    size_t i = 0;
+
+    while (n - i >= 4) {
+        size_t end = block_end(i, n);
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+
+        for (; i + 8 <= end; i += 8) {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+        for (; i + 4 <= end; i += 4) {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        }
+        total += sse_hsum(_mm_add_ps(acc0, acc1));
+    }
+    return total + scalar_dot(a + i, b + i, n - i);
+}
+
+/** @brief Perimeters of four triangles. */
+static inline __m128 sse_triangle_perimeter(__m128 base, __m128 height)
+{
+    __m128 half = _mm_mul_ps(base, _mm_set1_ps(0.5f));
+    __m128 side = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(half, half), _mm_mul_ps(height, height)));
+    return _mm_add_ps(base, _mm_add_ps(side, side));
+}
+
+/** @brief SSE shape_kernel_triangle_perimeters(). */
+static double sse_triangle_perimeters(const float *base, const float *height, size_t n)
+{
+    double total = 0.0;
+    size_t i = 0;
+
+    while (n - i >= 4) {
+        size_t end = block_end(i, n);
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+
+        for (; i + 8 <= end; i += 8) {
+            acc0 = _mm_add_ps(acc0, sse_triangle_perimeter(_mm_loadu_ps(base + i), _mm_loadu_ps(height + i)));
+            acc1 = _mm_add_ps(acc1, sse_triangle_perimeter(_mm_loadu_ps(base + i + 4), _mm_loadu_ps(height + i + 4)));
+        }
+        for (; i + 4 <= end; i += 4) {
+            acc0 = _mm_add_ps(acc0, sse_triangle_perimeter(_mm_loadu_ps(base + i), _mm_loadu_ps(height + i)));
+        }
+        total += sse_hsum(_mm_add_ps(acc0, acc1));
+    }
+    return total + scalar_triangle_perimeters(base + i, height + i, n - i);
+}
+
+/** @brief SSE shape_kernel_max(). */
+static float sse_max(const float *a, size_t n)
+{
+    __m128 acc0 = _mm_set1_ps(-INFINITY), acc1 = acc0;
+    float max, rest;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_max_ps(acc0, _mm_loadu_ps(a + i));
+        acc1 = _mm_max_ps(acc1, _mm_loadu_ps(a + i + 4));
+    }
+    max = sse_hmax(_mm_max_ps(acc0, acc1));
+    rest = scalar_max(a + i, n - i);
+    return rest > max ? rest : max;
+}
+
+/** @brief SSE kernels. */
+static const struct shape_kernel_table sse_kernels = {
+    .level = SHAPE_SIMD_SSE,
+    .sum = sse_sum,
+    .dot = sse_dot,
+    .triangle_perimeters = sse_triangle_perimeters,
+    .max = sse_max,
+};
+
+/* ============================================================================
+ * AVX2 Kernels (8 lanes, checked at run time)
+ * ============================================================================ */
+
+#define SHAPE_AVX2 __attribute__((target("avx2")))
+
+/** @brief Sum of the eight lanes. */
+SHAPE_AVX2 static inline float avx2_hsum(__m256 v)
+{
+    return sse_hsum(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+/** @brief AVX2 shape_kernel_sum(). */
+SHAPE_AVX2 static double avx2_sum(const float *a, size_t n)
+{
+    double total = 0.0;
+    size_t i = 0;
+
+    while (n - i >= 8) {
+        size_t end = block_end(i, n);
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+
+        for (; i + 16 <= end; i += 16) {
+            acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(a + i));
+            acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(a + i + 8));
+        }
+        for (; i + 8 <= end; i += 8) {
+            acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(a + i));
+        }
+        total += avx2_hsum(_mm256_add_ps(acc0, acc1));
+    }
+    return total + scalar_sum(a + i, n - i);
+}
+
+/** @brief AVX2 shape_kernel_dot(). */
+SHAPE_AVX2 static double avx2_dot(const float *a, const float *b, size_t n)
+{
+    double total = 0.0;
+    size_t i = 0;
+
+    while (n - i >= 8) {
+        size_t end = block_end(i, n);
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+
+        for (; i + 16 <= end; i += 16) {
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+            acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+        }
+        for (; i + 8 <= end; i += 8) {
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        }
+        total += avx2_hsum(_mm256_add_ps(acc0, acc1));
+    }
+    return total + scalar_dot(a + i, b + i, n - i);
+}
+
+/** @brief Perimeters of eight triangles. */
+SHAPE_AVX2 static inline __m256 avx2_triangle_perimeter(__m256 base, __m256 height)
+{
+    __m256 half = _mm256_mul_ps(base, _mm256_set1_ps(0.5f));
+    __m256 side = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(half, half), _mm256_mul_ps(height, height)));
+    return _mm256_add_ps(base, _mm256_add_ps(side, side));
+}
+
+/** @brief AVX2 shape_kernel_triangle_perimeters(). */
+SHAPE_AVX2 static double avx2_triangle_perimeters(const float *base, const float *height, size_t n)
+{
+    double total = 0.0;
+    size_t i = 0;
+
+    while (n - i >= 8) {
+        size_t end = block_end(i, n);
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+
+        for (; i + 16 <= end; i += 16) {
+            acc0 = _mm256_add_ps(acc0, avx2_triangle_perimeter(_mm256_loadu_ps(base + i), _mm256_loadu_ps(height + i)));
+            acc1 = _mm256_add_ps(acc1, avx2_triangle_perimeter(_mm256_loadu_ps(base + i + 8),
+                                                               _mm256_loadu_ps(height + i + 8)));
+        }
+        for (; i + 8 <= end; i += 8) {
+            acc0 = _mm256_add_ps(acc0, avx2_triangle_perimeter(_mm256_loadu_ps(base + i), _mm256_loadu_ps(height + i)));
+        }
+        total += avx2_hsum(_mm256_add_ps(acc0, acc1));
+    }
+    return total + scalar_triangle_perimeters(base + i, height + i, n - i);
+}
+
+/** @brief AVX2 shape_kernel_max(). */
+SHAPE_AVX2 static float avx2_max(const float *a, size_t n)
+{
+    __m256 acc0 = _mm256_set1_ps(-INFINITY), acc1 = acc0, m;
+    float max, rest;
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_max_ps(acc0, _mm256_loadu_ps(a + i));
+        acc1 = _mm256_max_ps(acc1, _mm256_loadu_ps(a + i + 8));
+    }
+    m = _mm256_max_ps(acc0, acc1);
+    max = sse_hmax(_mm_max_ps(_mm256_castps256_ps128(m), _mm256_extractf128_ps(m, 1)));
+    rest = scalar_max(a + i, n - i);
+    return rest > max ? rest : max;
+}
+
+/** @brief AVX2 kernels. */
+static const struct shape_kernel_table avx2_kernels = {
+    .level = SHAPE_SIMD_AVX2,
+    .sum = avx2_sum,
+    .dot = avx2_dot,
+    .triangle_perimeters = avx2_triangle_perimeters,
+    .max = avx2_max,
+};
+
+#endif /* SHAPE_KERNELS_X86 */
+
+/* ============================================================================
+ * Dispatch
+ * ============================================================================ */
+
+/** @brief Kernels in use; picked on first use. */
+static const struct shape_kernel_table *shape_kernels;
+
+/**
+ * @brief Highest level the CPU supports; SSE2 is part of x86-64.
+ */
+enum shape_simd shape_simd_best(void)
+{
+#ifdef SHAPE_KERNELS_X86
+    return __builtin_cpu_supports("avx2") ? SHAPE_SIMD_AVX2 : SHAPE_SIMD_SSE;
+#else
+    return SHAPE_SIMD_SCALAR;
+#endif
+}
+
+/**
+ * @brief Switch the kernel table, capped at what the CPU supports.
+ */
+enum shape_simd shape_simd_select(enum shape_simd level)
+{
+    enum shape_simd best = shape_simd_best();
+    const struct shape_kernel_table *table = &scalar_kernels;
+
+    if (level > best) level = best;
+#ifdef SHAPE_KERNELS_X86
+    if (level == SHAPE_SIMD_AVX2) table = &avx2_kernels;
+    if (level == SHAPE_SIMD_SSE) table = &sse_kernels;
+#endif
+    __atomic_store_n(&shape_kernels, table, __ATOMIC_RELEASE);
+    return table->level;
+}
+
+/**
+ * @brief Name of a level for reports.
+ */
+const char *shape_simd_name(enum shape_simd level)
+{
+    switch (level)
+    {
+        case SHAPE_SIMD_SSE:  return "sse";
+        case SHAPE_SIMD_AVX2: return "avx2";
+        default:              return "scalar";
+    }
+}
+
+/**
+ * @brief Kernels in use, selecting the best ones on first call.
+ */
+static const struct shape_kernel_table *kernels(void)
+{
+    const struct shape_kernel_table *table = __atomic_load_n(&shape_kernels, __ATOMIC_ACQUIRE);
+
+    if (!table) {
+        shape_simd_select(shape_simd_best());
+        table = __atomic_load_n(&shape_kernels, __ATOMIC_ACQUIRE);
+    }
+    return table;
+}
+
+/** @brief Dispatch to the selected implementation. */
+double shape_kernel_sum(const float *a, size_t n)
+{
+    if (!n) return 0.0;
+    return kernels()->sum(a, n);
+}
+
+/** @brief Dispatch to the selected implementation. */
+double shape_kernel_dot(const float *a, const float *b, size_t n)
+{
+    if (!n) return 0.0;
+    return kernels()->dot(a, b, n);
+}
+
+/** @brief Dispatch to the selected implementation. */
+double shape_kernel_triangle_perimeters(const float *base, const float *height, size_t n)
+{
+    if (!n) return 0.0;
+    return kernels()->triangle_perimeters(base, height, n);
+}
+
+/** @brief Dispatch to the selected implementation. */
+float shape_kernel_max(const float *a, size_t n)
+{
+    if (!n) return -INFINITY;
+    return kernels()->max(a, n);
+}
@@ -0,0 +1,75 @@
+/**
+ * @file shape_kernels.h
+ * @brief Vectorized reductions over shape parameter arrays.
+ * @details The batch operations of the shape store are built from these
+ *          kernels. Each comes in a scalar, an SSE and an AVX2 version; the
+ *          best one the CPU supports is picked at run time, and on other
+ *          architectures only the scalar version exists.
+ *
+ *          Sums are accumulated in float vector lanes over blocks of a few
+ *          thousand elements and each block is added to a double, so the
+ *          vector versions stay within float rounding of the scalar ones,
+ *          which accumulate in double throughout.
+ * @author Your Name
+ * @date December 8, 2025
+ * @version 1.0
+ */
+
+#ifndef SHAPE_KERNELS_H
+#define SHAPE_KERNELS_H
+
+#include <stddef.h>
+
+/**
+ * @enum shape_simd
+ * @brief Instruction set used by the kernels.
+ */
+enum shape_simd
+{
+    SHAPE_SIMD_SCALAR,  /**< Plain C, one element at a time */
+    SHAPE_SIMD_SSE,     /**< 4 floats per instruction */
+    SHAPE_SIMD_AVX2     /**< 8 floats per instruction */
+};
+
+/**
+ * @brief Highest instruction set this CPU supports.
+ * @return enum shape_simd Best available level.
+ */
+enum shape_simd shape_simd_best(void);
+
+/**
+ * @brief Limit the kernels to an instruction set, e.g. for comparison.
+ * @details Uses the highest supported level not above the one asked for.
+ *          Not thread-safe: call before starting threads that use kernels.
+ * @param level Highest level to use.
+ * @return enum shape_simd The level now in use.
+ */
+enum shape_simd shape_simd_select(enum shape_simd level);
+
+/**
+ * @brief Printable name of a level ("scalar", "sse", "avx2").
+ */
+const char *shape_simd_name(enum shape_simd level);
+
+/**
+ * @brief Sum of a[0..n).
+ */
+double shape_kernel_sum(const float *a, size_t n);
+
+/**
+ * @brief Sum of a[i] * b[i]; pass the same array twice for a sum of squares.
+ */
+double shape_kernel_dot(const float *a, const float *b, size_t n);
+
+/**
+ * @brief Sum of isosceles triangle perimeters: base + 2 * sqrt((base / 2)^2 + height^2).
+ */
+double shape_kernel_triangle_perimeters(const float *base, const float *height, size_t n);
+
+/**
+ * @brief Largest element of a[0..n).
+ * @return float The maximum, or -INFINITY if n is 0.
+ */
+float shape_kernel_max(const float *a, size_t n);
+
+#endif // SHAPE_KERNELS_H
@@ -0,0 +1,350 @@
+/**
+ * @file shape_sink.c
+ * @brief Buffered shape output: append buffer, encoders and fd flushing.
+ * @details Encoders reserve room for a whole record up front, so appending
+ *          never checks the buffer twice for one shape. Floats are printed
+ *          as "%.2f" without stdio: a float times 100 is exact in a double,
+ *          so rounding that to an integer in the default rounding mode gives
+ *          the same digits printf() does.
+ * @author Your Name
+ * @date December 8, 2025
+ * @version 1.0
+ */
+
+#include "shape_sink.h"
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/** @brief Upper bound of one encoded shape in either format. */
+#define SHAPE_SINK_RECORD_MAX 192
+
+/**
+ * @struct shape_sink_encoder
+ * @brief Output format: how one shape becomes bytes.
+ */
+struct shape_sink_encoder
+{
+    /**
+     * @brief Append one shape; room for SHAPE_SINK_RECORD_MAX bytes is reserved.
+     * @param out Where to write.
+     * @param type The type of shape.
+     * @param params shape_param_count(type) floats.
+     * @return char* End of the written bytes.
+     */
+    char *(*encode)(char *out, enum shape_type type, const float *params);
+};
+
+/**
+ * @struct shape_sink
+ * @brief Append buffer, its file descriptor and the encoder in use.
+ */
+struct shape_sink
+{
+    char *data;                                /**< Buffered bytes */
+    size_t size;                               /**< Bytes in use */
+    size_t capacity;                           /**< Allocated bytes */
+    int fd;                                    /**< Destination */
+    int error;                                 /**< errno of the first failed write, or 0 */
+    const struct shape_sink_encoder *encoder;  /**< Format of the shapes */
+};
+
+/* ============================================================================
+ * Buffer Management
+ * ============================================================================ */
+
+/**
+ * @brief Write bytes to the sink's descriptor.
+ * @details Retries partial writes and EINTR. Nothing is written once an
+ *          error has been recorded.
+ * @param sink Sink whose descriptor to use.
+ * @param data Bytes to write.
+ * @param size Number of bytes.
+ */
+static void shape_sink_write_fd(struct shape_sink *sink, const char *data, size_t size)
+{
+    size_t done = 0;
+
+    while (!sink->error && done < size) {
+        ssize_t n = write(sink->fd, data + done, size - done);
+        if (n > 0) {
+            done += (size_t)n;
+        } else if (n == 0) {
+            sink->error = EIO;
+        } else if (errno != EINTR) {
+            sink->error = errno;
+        }
+    }
+}
+
+/**
+ * @brief Write the buffer out and empty it, dropping it after an error.
+ * @param sink Sink to drain.
+ */
+static void shape_sink_drain(struct shape_sink *sink)
+{
+    shape_sink_write_fd(sink, sink->data, sink->size);
+    sink->size = 0;
+}
+
+/**
+ * @brief Make room for size bytes, draining the buffer if needed.
+ * @param sink Sink to append to.
+ * @param size Bytes about to be appended, at most the capacity.
+ * @return char* Where to write them.
+ */
+static char *shape_sink_reserve(struct shape_sink *sink, size_t size)
+{
+    if (sink->capacity - sink->size < size) {
+        shape_sink_drain(sink);
+    }
+    return sink->data + sink->size;
+}
+
+/* ============================================================================
+ * Text Encoder
+ * ============================================================================ */
+
+/** @brief "00" to "99", for printing two digits at a time. */
+static const char shape_sink_digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/**
+ * @brief Copy a string literal's bytes.
+ * @param out Where to write.
+ * @param text Bytes to copy.
+ * @param size Number of bytes.
+ * @return char* End of the written bytes.
+ */
+static char *shape_sink_copy(char *out, const char *text, size_t size)
+{
+    memcpy(out, text, size);
+    return out + size;
+}
+
+/** @brief Append a string literal without its terminator. */
+#define SHAPE_SINK_LITERAL(out, text) shape_sink_copy(out, text, sizeof(text) - 1)
+
+/**
+ * @brief Print a float like printf("%.2f").
+ * @details Values whose hundredths do not fit in 64 bits, infinities and
+ *          NaN take the snprintf() path.
+ * @param out Where to write, at least 64 bytes.
+ * @param value Value to print.
+ * @return char* End of the written bytes.
+ */
+static char *shape_sink_format_float(char *out, float value)
+{
+    double cents = fabs((double)value * 100.0);  /* exact: 24 + 7 significant bits */
+    char digits[24];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+    uint64_t whole;
+
+    if (!(cents < 1e18)) {
+        return out + snprintf(out, 64, "%.2f", value);
+    }
+    whole = (uint64_t)llrint(cents);  /* ties to even, as printf */
+
+    p -= 2;
+    memcpy(p, shape_sink_digit_pairs + 2 * (whole % 100), 2);
+    *--p = '.';
+    whole /= 100;
+    while (whole >= 100) {
+        p -= 2;
+        memcpy(p, shape_sink_digit_pairs + 2 * (whole % 100), 2);
+        whole /= 100;
+    }
+    if (whole >= 10) {
+        p -= 2;
+        memcpy(p, shape_sink_digit_pairs + 2 * whole, 2);
+    } else {
+        *--p = (char)('0' + whole);
+    }
+    if (signbit(value)) {
+        *--p = '-';
+    }
+    memcpy(out, p, (size_t)(end - p));
+    return out + (end - p);
+}
+
+/**
+ * @brief Encode a shape as the line shape_draw() prints.
+ */
+static char *shape_sink_text_encode(char *out, enum shape_type type, const float *params)
+{
+    switch (type)
+    {
+        case CIRCLE:
+            out = SHAPE_SINK_LITERAL(out, "Drawing circle with radius: ");
+            out = shape_sink_format_float(out, params[0]);
+            break;
+        case RECTANGLE:
+            out = SHAPE_SINK_LITERAL(out, "Drawing rectangle with width: ");
+            out = shape_sink_format_float(out, params[0]);
+            out = SHAPE_SINK_LITERAL(out, " and height: ");
+            out = shape_sink_format_float(out, params[1]);
+            break;
+        case TRIANGLE:
+            out = SHAPE_SINK_LITERAL(out, "Drawing triangle with base: ");
+            out = shape_sink_format_float(out, params[0]);
+            out = SHAPE_SINK_LITERAL(out, " and height: ");
+            out = shape_sink_format_float(out, params[1]);
+            break;
+        case SQUARE:
+            out = SHAPE_SINK_LITERAL(out, "Drawing square with side: ");
+            out = shape_sink_format_float(out, params[0]);
+            break;
+        default:
+            return out;
+    }
+    *out++ = '\n';
+    return out;
+}
+
+/* ============================================================================
+ * Binary Encoder
+ * ============================================================================ */
+
+/**
+ * @brief Encode a shape as its type byte and raw float parameters.
+ */
+static char *shape_sink_binary_encode(char *out, enum shape_type type, const float *params)
+{
+    size_t count = shape_param_count(type);
+
+    if (!count) return out;
+    *out++ = (char)type;
+    return shape_sink_copy(out, (const char *)params, count * sizeof(float));
+}
+
+/** @brief Encoders indexed by enum shape_sink_format. */
+static const struct shape_sink_encoder shape_sink_encoders[] = {
+    [SHAPE_SINK_TEXT]   = { shape_sink_text_encode },
+    [SHAPE_SINK_BINARY] = { shape_sink_binary_encode },
+};
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+/**
+ * @brief Allocate a sink and its buffer.
+ */
+struct shape_sink *shape_sink_create(int fd, enum shape_sink_format format, size_t buffer_size)
+{
+    struct shape_sink *sink;
+
+    if ((unsigned)format >= sizeof(shape_sink_encoders) / sizeof(shape_sink_encoders[0])) return NULL;
+    if (!buffer_size) buffer_size = SHAPE_SINK_DEFAULT_BUFFER;
+    if (buffer_size < SHAPE_SINK_RECORD_MAX) buffer_size = SHAPE_SINK_RECORD_MAX;
+
+    sink = malloc(sizeof(*sink));
+    if (!sink) return NULL;
+    sink->data = malloc(buffer_size);
+    if (!sink->data) {
+        free(sink);
+        return NULL;
+    }
+    sink->size = 0;
+    sink->capacity = buffer_size;
+    sink->fd = fd;
+    sink->error = 0;
+    sink->encoder = &shape_sink_encoders[format];
+    return sink;
+}
+
+/**
+ * @brief Encode one shape into the buffer.
+ */
+void shape_sink_put(struct shape_sink *sink, enum shape_type type, const float *params)
+{
+    char *out = shape_sink_reserve(sink, SHAPE_SINK_RECORD_MAX);
+    sink->size = (size_t)(sink->encoder->encode(out, type, params) - sink->data);
+}
+
+/**
+ * @brief Encode a shape object through its parameters.
+ */
+void shape_sink_draw(struct shape_sink *sink, shape_t shape)
+{
+    enum shape_type type;
+    float params[2];
+
+    if (shape_get_params(shape, &type, params)) {
+        shape_sink_put(sink, type, params);
+    }
+}
+
+/**
+ * @brief Encode a store bucket by bucket.
+ * @details The type is fixed per loop, so only the parameters are gathered
+ *          from the bucket arrays for each shape.
+ */
+void shape_sink_draw_store(struct shape_sink *sink, const struct shape_store *store)
+{
+    float params[2];
+    size_t i;
+
+    for (i = 0; i < store->circles.count; i++) {
+        shape_sink_put(sink, CIRCLE, &store->circles.radius[i]);
+    }
+    for (i = 0; i < store->rectangles.count; i++) {
+        params[0] = store->rectangles.width[i];
+        params[1] = store->rectangles.height[i];
+        shape_sink_put(sink, RECTANGLE, params);
+    }
+    for (i = 0; i < store->triangles.count; i++) {
+        params[0] = store->triangles.base[i];
+        params[1] = store->triangles.height[i];
+        shape_sink_put(sink, TRIANGLE, params);
+    }
+    for (i = 0; i < store->squares.count; i++) {
+        shape_sink_put(sink, SQUARE, &store->squares.side[i]);
+    }
+}
+
+/**
+ * @brief Append raw bytes; larger blocks than the buffer are written directly.
+ */
+void shape_sink_write(struct shape_sink *sink, const void *data, size_t size)
+{
+    if (size > sink->capacity - sink->size) {
+        shape_sink_drain(sink);
+    }
+    if (size > sink->capacity) {
+        shape_sink_write_fd(sink, data, size);
+        return;
+    }
+    memcpy(sink->data + sink->size, data, size);
+    sink->size += size;
+}
+
+/**
+ * @brief Drain the buffer and report the first write error.
+ */
+int shape_sink_flush(struct shape_sink *sink)
+{
+    shape_sink_drain(sink);
+    return sink->error;
+}
+
+/**
+ * @brief Flush, then free the buffer and the sink.
+ */
+int shape_sink_destroy(struct shape_sink *sink)
+{
+    int error;
+
+    if (!sink) return 0;
+    error = shape_sink_flush(sink);
+    free(sink->data);
+    free(sink);
+    return error;
+}
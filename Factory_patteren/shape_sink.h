@@ -0,0 +1,101 @@
+/**
+ * @file shape_sink.h
+ * @brief Buffered output sink for exporting shapes.
+ * @details shape_draw() prints every shape with its own printf() call, which
+ *          takes the stdio lock and parses the format string each time. A
+ *          sink instead encodes shapes into an append-only buffer and hands
+ *          it to write() only when it is full, so the cost per shape is a few
+ *          byte copies and the system calls are large.
+ *
+ *          Two encodings are available:
+ *          - SHAPE_SINK_TEXT: the same lines shape_draw() prints
+ *          - SHAPE_SINK_BINARY: per shape one byte of enum shape_type, then
+ *            its shape_param_count() floats in host byte order
+ * @author Your Name
+ * @date December 8, 2025
+ * @version 1.0
+ */
+
+#ifndef SHAPE_SINK_H
+#define SHAPE_SINK_H
+
+#include "shape.h"
+#include "shape_store.h"
+#include <stddef.h>
+
+/**
+ * @enum shape_sink_format
+ * @brief Encoding of the shapes written to a sink.
+ */
+enum shape_sink_format
+{
+    SHAPE_SINK_TEXT,    /**< "Drawing circle with radius: 10.00\n" */
+    SHAPE_SINK_BINARY   /**< Type byte followed by the float parameters */
+};
+
+/**
+ * @struct shape_sink
+ * @brief Opaque output buffer bound to a file descriptor.
+ */
+struct shape_sink;
+
+/** @brief Default buffer size of a sink (256 KiB). */
+#define SHAPE_SINK_DEFAULT_BUFFER (256u << 10)
+
+/**
+ * @brief Create a sink writing to a file descriptor.
+ * @param fd Descriptor to write to; the sink does not close it.
+ * @param format Encoding of the shapes.
+ * @param buffer_size Bytes buffered between writes, or 0 for SHAPE_SINK_DEFAULT_BUFFER.
+ * @return Pointer to the sink, or NULL on failure.
+ */
+struct shape_sink *shape_sink_create(int fd, enum shape_sink_format format, size_t buffer_size);
+
+/**
+ * @brief Encode one shape given by type and parameters.
+ * @param sink Sink to write to.
+ * @param type The type of shape.
+ * @param params shape_param_count(type) floats.
+ */
+void shape_sink_put(struct shape_sink *sink, enum shape_type type, const float *params);
+
+/**
+ * @brief Encode a shape object.
+ * @details The buffered counterpart of shape_draw().
+ * @param sink Sink to write to.
+ * @param shape Handle to the shape (NULL is ignored).
+ */
+void shape_sink_draw(struct shape_sink *sink, shape_t shape);
+
+/**
+ * @brief Encode every shape of a store, in the order of shape_store_draw().
+ * @param sink Sink to write to.
+ * @param store Store to export.
+ */
+void shape_sink_draw_store(struct shape_sink *sink, const struct shape_store *store);
+
+/**
+ * @brief Append raw bytes, e.g. a header in front of the shapes.
+ * @param sink Sink to write to.
+ * @param data Bytes to append.
+ * @param size Number of bytes.
+ */
+void shape_sink_write(struct shape_sink *sink, const void *data, size_t size);
+
+/**
+ * @brief Write out everything buffered so far.
+ * @param sink Sink to flush.
+ * @return int 0 on success, or the errno of the first failed write.
+ */
+int shape_sink_flush(struct shape_sink *sink);
+
+/**
+ * @brief Flush and free a sink.
+ * @details Once a write has failed, later output is discarded; the error is
+ *          reported here and by shape_sink_flush().
+ * @param sink Sink to destroy (NULL is ignored).
+ * @return int 0 on success, or the errno of the first failed write.
+ */
+int shape_sink_destroy(struct shape_sink *sink);
+
+#endif // SHAPE_SINK_H
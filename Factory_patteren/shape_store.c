@@ -0,0 +1,310 @@
+/**
+ * @file shape_store.c
+ * @brief Structure-of-arrays shape container and its batch operations.
+ * @details Each bucket grows by doubling. A batch operation is one loop per
+ *          bucket, so the shape type is known outside the loop and the body
+ *          reads consecutive floats.
+ * @author Your Name
+ * @date December 8, 2025
+ * @version 1.0
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* flockfile() */
+#include "shape_store.h"
+#include "shape_kernels.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** @brief Initial entries per bucket array. */
+#define SHAPE_STORE_MIN_CAPACITY 64
+
+/* ============================================================================
+ * Bucket Growth
+ * ============================================================================ */
+
+/**
+ * @brief Make room for a number of entries in every array of a bucket.
+ * @param arrays The bucket's arrays (one or two).
+ * @param array_count Number of arrays.
+ * @param needed Entries the arrays must hold.
+ * @param capacity Allocated entries; updated once every array has grown.
+ * @return int 1 on success, 0 if out of memory.
+ */
+static int shape_store_reserve(float **arrays[], int array_count, size_t needed, size_t *capacity)
+{
+    size_t new_capacity;
+    int i;
+
+    if (needed <= *capacity) return 1;
+    if (needed > (size_t)-1 / 2 / sizeof(float)) return 0;
+
+    new_capacity = *capacity ? *capacity * 2 : SHAPE_STORE_MIN_CAPACITY;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    for (i = 0; i < array_count; i++) {
+        float *grown = realloc(*arrays[i], new_capacity * sizeof(float));
+        if (!grown) return 0;
+        *arrays[i] = grown;
+    }
+    *capacity = new_capacity;
+    return 1;
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+/**
+ * @brief Create an empty store; arrays are allocated on first use.
+ * @return Pointer to the store, or NULL on failure.
+ */
+struct shape_store *shape_store_create(void)
+{
+    return calloc(1, sizeof(struct shape_store));
+}
+
+/**
+ * @brief Free every array and the store.
+ * @param store Store to destroy.
+ */
+void shape_store_destroy(struct shape_store *store)
+{
+    if (!store) return;
+
+    free(store->circles.radius);
+    free(store->rectangles.width);
+    free(store->rectangles.height);
+    free(store->triangles.base);
+    free(store->triangles.height);
+    free(store->squares.side);
+    free(store);
+}
+
+/**
+ * @brief Empty every bucket without freeing its arrays.
+ * @param store Store to clear.
+ */
+void shape_store_clear(struct shape_store *store)
+{
+    store->circles.count = 0;
+    store->rectangles.count = 0;
+    store->triangles.count = 0;
+    store->squares.count = 0;
+}
+
+/**
+ * @brief Total number of shapes.
+ * @param store Store to count.
+ * @return size_t Sum of the bucket counts.
+ */
+size_t shape_store_count(const struct shape_store *store)
+{
+    return store->circles.count + store->rectangles.count +
+           store->triangles.count + store->squares.count;
+}
+
+/**
+ * @brief Append a circle to the CIRCLE bucket.
+ */
+int shape_store_add_circle(struct shape_store *store, float radius)
+{
+    float **arrays[] = { &store->circles.radius };
+
+    if (!shape_store_reserve(arrays, 1, store->circles.count + 1, &store->circles.capacity)) return 0;
+    store->circles.radius[store->circles.count++] = radius;
+    return 1;
+}
+
+/**
+ * @brief Append a rectangle to the RECTANGLE bucket.
+ */
+int shape_store_add_rectangle(struct shape_store *store, float width, float height)
+{
+    float **arrays[] = { &store->rectangles.width, &store->rectangles.height };
+    size_t i = store->rectangles.count;
+
+    if (!shape_store_reserve(arrays, 2, i + 1, &store->rectangles.capacity)) return 0;
+    store->rectangles.width[i] = width;
+    store->rectangles.height[i] = height;
+    store->rectangles.count++;
+    return 1;
+}
+
+/**
+ * @brief Append a triangle to the TRIANGLE bucket.
+ */
+int shape_store_add_triangle(struct shape_store *store, float base, float height)
+{
+    float **arrays[] = { &store->triangles.base, &store->triangles.height };
+    size_t i = store->triangles.count;
+
+    if (!shape_store_reserve(arrays, 2, i + 1, &store->triangles.capacity)) return 0;
+    store->triangles.base[i] = base;
+    store->triangles.height[i] = height;
+    store->triangles.count++;
+    return 1;
+}
+
+/**
+ * @brief Append a square to the SQUARE bucket.
+ */
+int shape_store_add_square(struct shape_store *store, float side)
+{
+    float **arrays[] = { &store->squares.side };
+
+    if (!shape_store_reserve(arrays, 1, store->squares.count + 1, &store->squares.capacity)) return 0;
+    store->squares.side[store->squares.count++] = side;
+    return 1;
+}
+
+/**
+ * @brief Append n shapes of one type from a parameter buffer.
+ * @details The bucket grows at most once; two-parameter types are split
+ *          into their two arrays in the same pass.
+ */
+int shape_store_add_many(struct shape_store *store, enum shape_type type, const float *params, size_t n)
+{
+    float **arrays[2];
+    size_t *count, *capacity;
+    int array_count;
+    size_t i;
+
+    switch (type)
+    {
+        case CIRCLE:
+            arrays[0] = &store->circles.radius;
+            array_count = 1;
+            count = &store->circles.count;
+            capacity = &store->circles.capacity;
+            break;
+        case RECTANGLE:
+            arrays[0] = &store->rectangles.width;
+            arrays[1] = &store->rectangles.height;
+            array_count = 2;
+            count = &store->rectangles.count;
+            capacity = &store->rectangles.capacity;
+            break;
+        case TRIANGLE:
+            arrays[0] = &store->triangles.base;
+            arrays[1] = &store->triangles.height;
+            array_count = 2;
+            count = &store->triangles.count;
+            capacity = &store->triangles.capacity;
+            break;
+        case SQUARE:
+            arrays[0] = &store->squares.side;
+            array_count = 1;
+            count = &store->squares.count;
+            capacity = &store->squares.capacity;
+            break;
+        default:
+            return 0;
+    }
+
+    if (n > (size_t)-1 - *count) return 0;
+    if (!shape_store_reserve(arrays, array_count, *count + n, capacity)) return 0;
+    if (array_count == 1) {
+        memcpy(*arrays[0] + *count, params, n * sizeof(float));
+    } else {
+        float *first = *arrays[0] + *count;
+        float *second = *arrays[1] + *count;
+        for (i = 0; i < n; i++) {
+            first[i] = params[2 * i];
+            second[i] = params[2 * i + 1];
+        }
+    }
+    *count += n;
+    return 1;
+}
+
+/**
+ * @brief Draw all shapes bucket by bucket.
+ * @details The lines match the shape_*_draw() implementations in shape.c.
+ *          The stream is locked once for the batch rather than once per
+ *          line.
+ * @param store Store to draw.
+ * @param out Stream to print to.
+ */
+void shape_store_draw(const struct shape_store *store, FILE *out)
+{
+    size_t i;
+
+    flockfile(out);
+    for (i = 0; i < store->circles.count; i++) {
+        fprintf(out, "Drawing circle with radius: %.2f\n", store->circles.radius[i]);
+    }
+    for (i = 0; i < store->rectangles.count; i++) {
+        fprintf(out, "Drawing rectangle with width: %.2f and height: %.2f\n",
+                store->rectangles.width[i], store->rectangles.height[i]);
+    }
+    for (i = 0; i < store->triangles.count; i++) {
+        fprintf(out, "Drawing triangle with base: %.2f and height: %.2f\n",
+                store->triangles.base[i], store->triangles.height[i]);
+    }
+    for (i = 0; i < store->squares.count; i++) {
+        fprintf(out, "Drawing square with side: %.2f\n", store->squares.side[i]);
+    }
+    funlockfile(out);
+}
+
+/* ============================================================================
+ * Batch Geometry
+ * ============================================================================ */
+
+/** @brief Pi as a double, for scaling the circle sums. */
+#define SHAPE_STORE_PI 3.14159265358979323846
+
+/**
+ * @brief Total area, one kernel call per bucket.
+ */
+double shape_store_total_area(const struct shape_store *store)
+{
+    return SHAPE_STORE_PI * shape_kernel_dot(store->circles.radius, store->circles.radius, store->circles.count) +
+           shape_kernel_dot(store->rectangles.width, store->rectangles.height, store->rectangles.count) +
+           0.5 * shape_kernel_dot(store->triangles.base, store->triangles.height, store->triangles.count) +
+           shape_kernel_dot(store->squares.side, store->squares.side, store->squares.count);
+}
+
+/**
+ * @brief Total perimeter, one kernel call per array.
+ */
+double shape_store_total_perimeter(const struct shape_store *store)
+{
+    return 2.0 * SHAPE_STORE_PI * shape_kernel_sum(store->circles.radius, store->circles.count) +
+           2.0 * (shape_kernel_sum(store->rectangles.width, store->rectangles.count) +
+                  shape_kernel_sum(store->rectangles.height, store->rectangles.count)) +
+           shape_kernel_triangle_perimeters(store->triangles.base, store->triangles.height, store->triangles.count) +
+           4.0 * shape_kernel_sum(store->squares.side, store->squares.count);
+}
+
+/**
+ * @brief Union of all bounds.
+ * @details Circles extend from -radius to radius, every other shape from 0
+ *          to its width and height, so the union only needs the largest
+ *          value of each array.
+ */
+struct shape_bounds shape_store_bounds(const struct shape_store *store)
+{
+    float radius = shape_kernel_max(store->circles.radius, store->circles.count);
+    float width = fmaxf(fmaxf(shape_kernel_max(store->rectangles.width, store->rectangles.count),
+                              shape_kernel_max(store->triangles.base, store->triangles.count)),
+                        shape_kernel_max(store->squares.side, store->squares.count));
+    float height = fmaxf(fmaxf(shape_kernel_max(store->rectangles.height, store->rectangles.count),
+                               shape_kernel_max(store->triangles.height, store->triangles.count)),
+                         shape_kernel_max(store->squares.side, store->squares.count));
+    struct shape_bounds bounds = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    /* An empty bucket reports -INFINITY and drops out of the maxima. */
+    if (store->circles.count) {
+        bounds = (struct shape_bounds){ -radius, -radius, radius, radius };
+    }
+    if (store->rectangles.count || store->triangles.count || store->squares.count) {
+        bounds.min_x = fminf(bounds.min_x, 0.0f);
+        bounds.min_y = fminf(bounds.min_y, 0.0f);
+        bounds.max_x = store->circles.count ? fmaxf(bounds.max_x, width) : width;
+        bounds.max_y = store->circles.count ? fmaxf(bounds.max_y, height) : height;
+    }
+    return bounds;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file shape_store.h
+ * @brief Structure-of-arrays container for large shape collections.
+ * @details Keeps every shape type in its own bucket of contiguous parameter
+ *          arrays (radius[], width[], height[], ...) instead of one heap
+ *          object per shape. Batch operations walk one bucket at a time in
+ *          a tight loop, without vtable calls or a branch on the type, and
+ *          touch only the arrays they need.
+ * @author Your Name
+ * @date December 8, 2025
+ * @version 1.0
+ */
+
+#ifndef SHAPE_STORE_H
+#define SHAPE_STORE_H
+
+#include "shape.h"
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @struct shape_store
+ * @brief Type-bucketed shape parameters, one array per field.
+ * @details The arrays are public so callers can run their own loops over a
+ *          bucket; grow the store only through the add functions.
+ */
+struct shape_store
+{
+    struct
+    {
+        float *radius;       /**< Radius of each circle */
+        size_t count;        /**< Circles in the bucket */
+        size_t capacity;     /**< Allocated entries per array */
+    } circles;               /**< CIRCLE bucket */
+
+    struct
+    {
+        float *width;        /**< Width of each rectangle */
+        float *height;       /**< Height of each rectangle */
+        size_t count;        /**< Rectangles in the bucket */
+        size_t capacity;     /**< Allocated entries per array */
+    } rectangles;            /**< RECTANGLE bucket */
+
+    struct
+    {
+        float *base;         /**< Base length of each triangle */
+        float *height;       /**< Height of each triangle */
+        size_t count;        /**< Triangles in the bucket */
+        size_t capacity;     /**< Allocated entries per array */
+    } triangles;             /**< TRIANGLE bucket */
+
+    struct
+    {
+        float *side;         /**< Side length of each square */
+        size_t count;        /**< Squares in the bucket */
+        size_t capacity;     /**< Allocated entries per array */
+    } squares;               /**< SQUARE bucket */
+};
+
+/**
+ * @brief Create an empty shape store.
+ * @return Pointer to the store, or NULL on failure.
+ */
+struct shape_store *shape_store_create(void);
+
+/**
+ * @brief Free a shape store and all of its arrays.
+ * @param store Store to destroy (NULL is ignored).
+ */
+void shape_store_destroy(struct shape_store *store);
+
+/**
+ * @brief Remove every shape but keep the arrays for reuse.
+ * @param store Store to clear.
+ */
+void shape_store_clear(struct shape_store *store);
+
+/**
+ * @brief Number of shapes in all buckets.
+ * @param store Store to count.
+ * @return size_t Total number of shapes.
+ */
+size_t shape_store_count(const struct shape_store *store);
+
+/**
+ * @brief Append a circle.
+ * @return int 1 on success, 0 if out of memory.
+ */
+int shape_store_add_circle(struct shape_store *store, float radius);
+
+/**
+ * @brief Append a rectangle.
+ * @return int 1 on success, 0 if out of memory.
+ */
+int shape_store_add_rectangle(struct shape_store *store, float width, float height);
+
+/**
+ * @brief Append a triangle.
+ * @return int 1 on success, 0 if out of memory.
+ */
+int shape_store_add_triangle(struct shape_store *store, float base, float height);
+
+/**
+ * @brief Append a square.
+ * @return int 1 on success, 0 if out of memory.
+ */
+int shape_store_add_square(struct shape_store *store, float side);
+
+/**
+ * @brief Append n shapes of one type from a parameter buffer.
+ * @details Parameters are laid out as for shape_create_many().
+ * @param store Store to append to.
+ * @param type The type of the shapes.
+ * @param params n * shape_param_count(type) floats.
+ * @param n Number of shapes.
+ * @return int 1 on success, 0 if out of memory or the type is unknown.
+ */
+int shape_store_add_many(struct shape_store *store, enum shape_type type, const float *params, size_t n);
+
+/**
+ * @brief Draw every shape in the store, one type bucket after the other.
+ * @details Prints the same lines as shape_draw() would, grouped by type,
+ *          holding the stream lock for the whole batch.
+ * @param store Store to draw.
+ * @param out Stream to print to, e.g. stdout.
+ */
+void shape_store_draw(const struct shape_store *store, FILE *out);
+
+/**
+ * @brief Sum of the areas of all shapes, same formulas as shape_area().
+ * @details Runs the vectorized kernels (shape_kernels.h) over each bucket.
+ * @param store Store to measure.
+ * @return double Total area.
+ */
+double shape_store_total_area(const struct shape_store *store);
+
+/**
+ * @brief Sum of the perimeters of all shapes, same formulas as shape_perimeter().
+ * @param store Store to measure.
+ * @return double Total perimeter.
+ */
+double shape_store_total_perimeter(const struct shape_store *store);
+
+/**
+ * @brief Bounding box of all shapes, each placed as for shape_get_bounds().
+ * @param store Store to measure.
+ * @return struct shape_bounds Union of the shape bounds, all zero if empty.
+ */
+struct shape_bounds shape_store_bounds(const struct shape_store *store);
+
+#endif // SHAPE_STORE_H
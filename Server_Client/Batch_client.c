@@ -0,0 +1,313 @@
+#define _GNU_SOURCE
+#include "batch_client.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#define READ_SIZE    65536
+
+static unsigned long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+}
+
+bool batch_client_connect(BatchClient* client, const BatchClientConfig* config)
+{
+    struct sockaddr_in addr;
+    int one = 1;
+
+    memset(client, 0, sizeof(*client));
+    client->fd = -1;
+    client->batch_bytes = config->batch_bytes ? config->batch_bytes : BATCH_CLIENT_DEFAULT_BYTES;
+    client->batch_ns = (config->batch_us ? config->batch_us : BATCH_CLIENT_DEFAULT_US) * 1000ull;
+    client->low_latency = config->low_latency;
+    frame_reader_initialize(&client->frames, config->max_frame);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config->port);
+    if (inet_pton(AF_INET, config->address ? config->address : "127.0.0.1", &addr.sin_addr) != 1)
+    {
+        errno = EINVAL;
+        return false;
+    }
+    client->read_buffer = malloc(READ_SIZE);
+    client->fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (client->read_buffer == NULL || client->fd < 0 ||
+        connect(client->fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        batch_client_close(client);
+        return false;
+    }
+    setsockopt(client->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return true;
+}
+
+void batch_client_close(BatchClient* client)
+{
+    if (client->fd >= 0)
+    {
+        close(client->fd);
+    }
+    client->fd = -1;
+    frame_reader_deinitialize(&client->frames);
+    free(client->read_buffer);
+    free(client->arena);
+    free(client->segments);
+    free(client->iov);
+    client->read_buffer = NULL;
+    client->arena = NULL;
+    client->segments = NULL;
+    client->iov = NULL;
+    client->segment_count = 0;
+    client->segment_capacity = 0;
+    client->arena_size = 0;
+    client->arena_capacity = 0;
+    client->queued_bytes = 0;
+}
+
+static bool arena_reserve(BatchClient* client, size_t length)
+{
+    size_t capacity = client->arena_capacity ? client->arena_capacity : 4096;
+    unsigned char* arena;
+
+    if (client->arena_size + length <= client->arena_capacity)
+    {
+        return true;
+    }
+    while (capacity < client->arena_size + length)
+    {
+        capacity *= 2;
+    }
+    arena = realloc(client->arena, capacity);
+    if (arena == NULL)
+    {
+        return false;
+    }
+    client->arena = arena;
+    client->arena_capacity = capacity;
+    return true;
+}
+
+static bool segment_reserve(BatchClient* client, size_t count)
+{
+    size_t capacity = client->segment_capacity ? client->segment_capacity : 64;
+    BatchSegment* segments;
+    struct iovec* iov;
+
+    if (client->segment_count + count <= client->segment_capacity)
+    {
+        return true;
+    }
+    while (capacity < client->segment_count + count)
+    {
+        capacity *= 2;
+    }
+    segments = realloc(client->segments, capacity * sizeof(*segments));
+    if (segments == NULL)
+    {
+        return false;
+    }
+    client->segments = segments;
+    iov = realloc(client->iov, capacity * sizeof(*iov));
+    if (iov == NULL)
+    {
+        return false;
+    }
+    client->iov = iov;
+    client->segment_capacity = capacity;
+    return true;
+}
+
+// Callers reserve first (segment_reserve()), so this cannot fail.
+static BatchSegment* segment_add(BatchClient* client)
+{
+    return &client->segments[client->segment_count++];
+}
+
+// Copies bytes into the arena, growing the last segment when it is the
+// arena tail so that consecutive small frames become one iovec. Arena and
+// segment space must already be reserved.
+static void arena_append(BatchClient* client, const void* data, size_t length)
+{
+    BatchSegment* last = client->segment_count ? &client->segments[client->segment_count - 1] : NULL;
+
+    if (last == NULL || last->data != NULL || last->offset + last->length != client->arena_size)
+    {
+        last = segment_add(client);
+        last->data = NULL;
+        last->offset = client->arena_size;
+        last->length = 0;
+    }
+    memcpy(client->arena + client->arena_size, data, length);
+    client->arena_size += length;
+    last->length += length;
+}
+
+static bool queued(BatchClient* client, size_t length)
+{
+    if (client->queued_bytes == 0)
+    {
+        client->oldest_ns = now_ns();
+    }
+    client->queued_bytes += FRAME_HEADER_SIZE + length;
+    client->messages++;
+    if (client->low_latency || client->queued_bytes >= client->batch_bytes)
+    {
+        return batch_client_flush(client);
+    }
+    return batch_client_poll(client);
+}
+
+static bool queue(BatchClient* client, const void* data, size_t length, bool copy)
+{
+    unsigned char header[FRAME_HEADER_SIZE];
+    bool copied = copy || length < BATCH_CLIENT_COPY_LIMIT;
+
+    if (client->failed)
+    {
+        errno = EPIPE;
+        return false;
+    }
+    if (length > UINT32_MAX)
+    {
+        errno = EMSGSIZE;
+        return false;
+    }
+    // Room for the header and the payload is reserved together: a header
+    // queued without its payload would misframe the rest of the stream.
+    if (!arena_reserve(client, sizeof(header) + (copied ? length : 0)) ||
+        !segment_reserve(client, 2))
+    {
+        return false;
+    }
+    frame_write_header(header, (uint32_t)length);
+    arena_append(client, header, sizeof(header));
+    if (copied)
+    {
+        if (length > 0)
+        {
+            arena_append(client, data, length);
+        }
+    }
+    else
+    {
+        BatchSegment* segment = segment_add(client);
+        segment->data = data;
+        segment->offset = 0;
+        segment->length = length;
+    }
+    return queued(client, length);
+}
+
+bool batch_client_queue(BatchClient* client, const void* data, size_t length)
+{
+    return queue(client, data, length, true);
+}
+
+bool batch_client_queue_ref(BatchClient* client, const void* data, size_t length)
+{
+    return queue(client, data, length, false);
+}
+
+bool batch_client_flush(BatchClient* client)
+{
+    struct iovec* iov = client->iov;
+    size_t count = client->segment_count;
+    size_t i;
+
+    if (client->failed)
+    {
+        errno = EPIPE;
+        return false;
+    }
+    if (count == 0)
+    {
+        return true;
+    }
+    // Arena offsets are resolved only now; the arena may have moved while
+    // the batch was being built.
+    for (i = 0; i < count; i++)
+    {
+        const BatchSegment* segment = &client->segments[i];
+        iov[i].iov_base = segment->data ? (void*)segment->data : client->arena + segment->offset;
+        iov[i].iov_len = segment->length;
+    }
+
+    while (count > 0)
+    {
+        ssize_t sent = writev(client->fd, iov, count < IOV_MAX ? (int)count : IOV_MAX);
+
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            // Part of the batch may be on the wire already, so the stream
+            // cannot be resumed: drop the rest and refuse further frames.
+            client->failed = true;
+            client->segment_count = 0;
+            client->arena_size = 0;
+            client->queued_bytes = 0;
+            return false;
+        }
+        client->bytes += (unsigned long long)sent;
+        while (count > 0 && (size_t)sent >= iov->iov_len)
+        {
+            sent -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0)
+        {
+            iov->iov_base = (unsigned char*)iov->iov_base + sent;
+            iov->iov_len -= (size_t)sent;
+        }
+    }
+
+    client->batches++;
+    client->segment_count = 0;
+    client->arena_size = 0;
+    client->queued_bytes = 0;
+    return true;
+}
+
+bool batch_client_poll(BatchClient* client)
+{
+    if (client->queued_bytes > 0 && now_ns() - client->oldest_ns >= client->batch_ns)
+    {
+        return batch_client_flush(client);
+    }
+    return true;
+}
+
+bool batch_client_receive(BatchClient* client, FrameHandler handler, void* ctx)
+{
+    size_t space;
+    void* ring = frame_reader_space(&client->frames, &space);
+    ssize_t received;
+
+    // Same as the reactor: while a frame is split, receive into the ring.
+    do
+    {
+        received = ring ? recv(client->fd, ring, space, 0)
+                        : recv(client->fd, client->read_buffer, READ_SIZE, 0);
+    }
+    while (received < 0 && errno == EINTR);
+    if (received <= 0)
+    {
+        return false;
+    }
+    return ring ? frame_reader_commit(&client->frames, (size_t)received, handler, ctx)
+                : frame_reader_feed(&client->frames, client->read_buffer, (size_t)received, handler, ctx);
+}
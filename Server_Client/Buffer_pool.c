@@ -0,0 +1,137 @@
+#define _GNU_SOURCE
+#include "buffer_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+bool buffer_pool_initialize(BufferPool* pool, size_t buffer_size, size_t slab_buffers, bool mirrored)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    memset(pool, 0, sizeof(*pool));
+    pool->buffer_size = buffer_size ? buffer_size : BUFFER_POOL_DEFAULT_SIZE;
+    pool->slab_buffers = slab_buffers ? slab_buffers : BUFFER_POOL_SLAB_BUFFERS;
+    pool->mirrored = mirrored;
+    return (pool->buffer_size & (pool->buffer_size - 1)) == 0 && pool->buffer_size % page == 0;
+}
+
+static size_t slab_span(const BufferPool* pool)
+{
+    return pool->slab_buffers * pool->buffer_size * (pool->mirrored ? 2 : 1);
+}
+
+void buffer_pool_deinitialize(BufferPool* pool)
+{
+    size_t i;
+
+    for (i = 0; i < pool->slab_count; i++)
+    {
+        munmap(pool->slabs[i], slab_span(pool));
+    }
+    free(pool->slabs);
+    pool->slabs = NULL;
+    pool->slab_count = 0;
+    pool->slab_capacity = 0;
+    pool->free_list = NULL;
+    pool->carve = NULL;
+    pool->carve_left = 0;
+    pool->buffers = 0;
+    pool->in_use = 0;
+}
+
+// One memfd backs the whole slab; buffer i is its i-th page run, mapped
+// at two adjacent addresses. The fd is closed once everything is mapped.
+static unsigned char* map_mirrored(const BufferPool* pool)
+{
+    size_t size = pool->buffer_size, i;
+    unsigned char* base;
+    int fd = memfd_create("buffer_pool", MFD_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    base = ftruncate(fd, (off_t)(size * pool->slab_buffers)) == 0 ?
+           mmap(NULL, slab_span(pool), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) : MAP_FAILED;
+    for (i = 0; base != MAP_FAILED && i < pool->slab_buffers; i++)
+    {
+        unsigned char* buffer = base + 2 * i * size;
+        off_t offset = (off_t)(i * size);
+
+        if (mmap(buffer, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, offset) == MAP_FAILED ||
+            mmap(buffer + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, offset) == MAP_FAILED)
+        {
+            munmap(base, slab_span(pool));
+            base = MAP_FAILED;
+        }
+    }
+    close(fd);
+    return base == MAP_FAILED ? NULL : base;
+}
+
+static bool grow(BufferPool* pool)
+{
+    unsigned char* slab;
+
+    if (pool->slab_count == pool->slab_capacity)
+    {
+        size_t capacity = pool->slab_capacity ? pool->slab_capacity * 2 : 8;
+        unsigned char** slabs = realloc(pool->slabs, capacity * sizeof(*slabs));
+        if (slabs == NULL)
+        {
+            return false;
+        }
+        pool->slabs = slabs;
+        pool->slab_capacity = capacity;
+    }
+    if (pool->mirrored)
+    {
+        slab = map_mirrored(pool);
+    }
+    else
+    {
+        slab = mmap(NULL, slab_span(pool), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        slab = slab == MAP_FAILED ? NULL : slab;
+    }
+    if (slab == NULL)
+    {
+        return false;
+    }
+    pool->slabs[pool->slab_count++] = slab;
+    // Carved lazily, so pages of buffers never used are never touched.
+    pool->carve = slab;
+    pool->carve_left = pool->slab_buffers;
+    return true;
+}
+
+void* buffer_pool_acquire(BufferPool* pool)
+{
+    void* buffer = pool->free_list;
+
+    if (buffer)
+    {
+        pool->free_list = *(void**)buffer;
+    }
+    else
+    {
+        if (pool->carve_left == 0 && !grow(pool))
+        {
+            return NULL;
+        }
+        buffer = pool->carve;
+        pool->carve += pool->buffer_size * (pool->mirrored ? 2 : 1);
+        pool->carve_left--;
+        pool->buffers++;
+    }
+    pool->in_use++;
+    pool->acquired++;
+    return buffer;
+}
+
+void buffer_pool_release(BufferPool* pool, void* buffer)
+{
+    *(void**)buffer = pool->free_list;
+    pool->free_list = buffer;
+    pool->in_use--;
+}
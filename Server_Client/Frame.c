@@ -0,0 +1,247 @@
+#define _GNU_SOURCE
+#include "frame.h"
+#include "buffer_pool.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// Maps size bytes of a memfd twice, back to back, so ring + offset is
+// contiguous for up to size bytes from any offset.
+static unsigned char* ring_map(size_t size)
+{
+    unsigned char* base;
+    int fd = memfd_create("frame_ring", MFD_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    base = ftruncate(fd, (off_t)size) == 0 ?
+           mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) : MAP_FAILED;
+    if (base == MAP_FAILED ||
+        mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+        mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        if (base != MAP_FAILED)
+        {
+            munmap(base, 2 * size);
+        }
+        close(fd);
+        return NULL;
+    }
+    // The mappings keep the memory alive.
+    close(fd);
+    return base;
+}
+
+void frame_reader_initialize(FrameReader* reader, size_t max_length)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->max_length = max_length ? max_length : FRAME_DEFAULT_MAX_LENGTH;
+}
+
+void frame_reader_use_pool(FrameReader* reader, struct BufferPool* pool)
+{
+    reader->pool = pool;
+}
+
+static void ring_free(FrameReader* reader)
+{
+    if (reader->pooled)
+    {
+        buffer_pool_release(reader->pool, reader->ring);
+    }
+    else if (reader->ring)
+    {
+        munmap(reader->ring, 2 * reader->capacity);
+    }
+    reader->ring = NULL;
+    reader->capacity = 0;
+    reader->pooled = false;
+}
+
+void frame_reader_deinitialize(FrameReader* reader)
+{
+    ring_free(reader);
+    reader->head = 0;
+    reader->size = 0;
+}
+
+// Makes room for at least needed pending bytes. Growing moves the pending
+// bytes to the start of the new ring; that is the only copy besides the
+// one gathering a split frame.
+static bool reserve(FrameReader* reader, size_t needed)
+{
+    size_t capacity = reader->capacity ? reader->capacity : FRAME_RING_MIN_SIZE;
+    unsigned char* ring;
+
+    if (reader->ring && needed <= reader->capacity)
+    {
+        return true;
+    }
+    if (reader->ring == NULL && reader->pool && needed <= reader->pool->buffer_size)
+    {
+        reader->ring = buffer_pool_acquire(reader->pool);
+        if (reader->ring)
+        {
+            reader->capacity = reader->pool->buffer_size;
+            reader->head = 0;
+            reader->pooled = true;
+            return true;
+        }
+    }
+    while (capacity < needed)
+    {
+        capacity *= 2;
+    }
+    ring = ring_map(capacity);
+    if (ring == NULL)
+    {
+        return false;
+    }
+    if (reader->ring)
+    {
+        memcpy(ring, reader->ring + reader->head, reader->size);
+        ring_free(reader);
+    }
+    reader->ring = ring;
+    reader->capacity = capacity;
+    reader->head = 0;
+    return true;
+}
+
+static bool append(FrameReader* reader, const unsigned char* data, size_t length)
+{
+    if (!reserve(reader, reader->size + length))
+    {
+        return false;
+    }
+    memcpy(reader->ring + ((reader->head + reader->size) & (reader->capacity - 1)), data, length);
+    reader->size += length;
+    return true;
+}
+
+// Bytes still missing from the first pending frame (or its header).
+static size_t missing(const FrameReader* reader)
+{
+    if (reader->size < FRAME_HEADER_SIZE)
+    {
+        return FRAME_HEADER_SIZE - reader->size;
+    }
+    return FRAME_HEADER_SIZE + frame_read_header(reader->ring + reader->head) - reader->size;
+}
+
+static bool parse_ring(FrameReader* reader, FrameHandler handler, void* ctx)
+{
+    while (reader->size >= FRAME_HEADER_SIZE)
+    {
+        size_t length = frame_read_header(reader->ring + reader->head);
+        size_t total = FRAME_HEADER_SIZE + length;
+        const unsigned char* payload;
+
+        if (length > reader->max_length || !reserve(reader, total))
+        {
+            return false;
+        }
+        if (reader->size < total)
+        {
+            break;
+        }
+        payload = reader->ring + reader->head + FRAME_HEADER_SIZE;
+        reader->head = (reader->head + total) & (reader->capacity - 1);
+        reader->size -= total;
+        if (!handler(ctx, payload, length))
+        {
+            return false;
+        }
+    }
+    if (reader->size == 0)
+    {
+        reader->head = 0;
+        // Drained: a pooled reader keeps no ring while idle.
+        if (reader->pool)
+        {
+            ring_free(reader);
+        }
+    }
+    return true;
+}
+
+bool frame_reader_feed(FrameReader* reader, const void* data, size_t length,
+                       FrameHandler handler, void* ctx)
+{
+    const unsigned char* p = data;
+    size_t max_length;
+
+    // Finish the split frame first, taking no more than it needs so that
+    // the frames after it can still be passed without copying.
+    while (length > 0 && reader->size > 0)
+    {
+        size_t take = missing(reader);
+
+        take = take < length ? take : length;
+        if (!append(reader, p, take))
+        {
+            return false;
+        }
+        p += take;
+        length -= take;
+        if (!parse_ring(reader, handler, ctx))
+        {
+            return false;
+        }
+    }
+
+    // Local copy: the handler calls would otherwise force a reload.
+    max_length = reader->max_length;
+    while (length >= FRAME_HEADER_SIZE)
+    {
+        size_t frame = frame_read_header(p);
+
+        // Each header address depends on the previous header, which the
+        // hardware prefetcher cannot see through for small frames.
+        __builtin_prefetch(p + 512);
+        if (frame > max_length)
+        {
+            return false;
+        }
+        if (length - FRAME_HEADER_SIZE < frame)
+        {
+            break;
+        }
+        p += FRAME_HEADER_SIZE + frame;
+        length -= FRAME_HEADER_SIZE + frame;
+        if (!handler(ctx, p - frame, frame))
+        {
+            return false;
+        }
+    }
+
+    if (length > 0)
+    {
+        if (length >= FRAME_HEADER_SIZE && frame_read_header(p) > reader->max_length)
+        {
+            return false;
+        }
+        return append(reader, p, length) &&
+               (length < FRAME_HEADER_SIZE || reserve(reader, FRAME_HEADER_SIZE + frame_read_header(p)));
+    }
+    return true;
+}
+
+void* frame_reader_space(FrameReader* reader, size_t* space)
+{
+    if (reader->size == 0 || reader->ring == NULL)
+    {
+        *space = 0;
+        return NULL;
+    }
+    *space = reader->capacity - reader->size;
+    return reader->ring + ((reader->head + reader->size) & (reader->capacity - 1));
+}
+
+bool frame_reader_commit(FrameReader* reader, size_t length, FrameHandler handler, void* ctx)
+{
+    reader->size += length;
+    return parse_ring(reader, handler, ctx);
+}
@@ -0,0 +1,829 @@
+#define _GNU_SOURCE
+#include "reactor_uring.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <time.h>
+
+static int listen_socket(const ReactorConfig* config)
+{
+    struct sockaddr_in srv;
+    int fd, one = 1;
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (config->reuse_port && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    memset(&srv, 0, sizeof(srv));
+    srv.sin_family = AF_INET;
+    srv.sin_port = htons(config->port);
+    srv.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (config->address && inet_pton(AF_INET, config->address, &srv.sin_addr) != 1)
+    {
+        close(fd);
+        return -1;
+    }
+
+    if (bind(fd, (struct sockaddr*)&srv, sizeof(srv)) < 0 ||
+        listen(fd, config->backlog > 0 ? config->backlog : REACTOR_DEFAULT_BACKLOG) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool watch_op(Reactor* reactor, int op, int fd, uint32_t events)
+{
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.u64 = 0;
+    ev.data.fd = fd;
+    return epoll_ctl(reactor->epoll_fd, op, fd, &ev) == 0;
+}
+
+static bool watch(Reactor* reactor, int fd, uint32_t events)
+{
+    return watch_op(reactor, EPOLL_CTL_ADD, fd, events);
+}
+
+// Single writer, readers on other threads: a plain add, published whole.
+#define STAT_ADD(field, n)    __atomic_store_n(&(field), (field) + (n), __ATOMIC_RELAXED)
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t current_tick(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000) / REACTOR_TIMER_TICK_MS;
+}
+
+// Periodic timerfd for the idle wheel; watched like the wake fd.
+static int timer_socket(void)
+{
+    struct itimerspec tick;
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+    tick.it_interval.tv_sec = REACTOR_TIMER_TICK_MS / 1000;
+    tick.it_interval.tv_nsec = (REACTOR_TIMER_TICK_MS % 1000) * 1000000L;
+    tick.it_value = tick.it_interval;
+    if (timerfd_settime(fd, 0, &tick, NULL) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool reactor_initialize(Reactor* reactor, const ReactorConfig* config)
+{
+    memset(reactor, 0, sizeof(*reactor));
+    reactor->epoll_fd = -1;
+    reactor->read_size = config->read_size ? config->read_size : REACTOR_DEFAULT_READ_SIZE;
+    reactor->on_data = config->on_data;
+    reactor->on_frame = config->on_frame;
+    reactor->max_frame = config->max_frame;
+    reactor->on_open = config->on_open;
+    reactor->on_close = config->on_close;
+    reactor->ctx = config->ctx;
+    reactor->next_id = 1;
+    reactor->timer_fd = -1;
+    buffer_pool_initialize(&reactor->buffers, 0, 0, true);
+    timer_wheel_initialize(&reactor->timers, current_tick());
+    // +1: the deadline is taken from the last tick, up to a tick ago.
+    reactor->idle_ticks = (config->idle_timeout_ms + REACTOR_TIMER_TICK_MS - 1) / REACTOR_TIMER_TICK_MS + 1;
+
+    reactor->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    reactor->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    reactor->listen_fd = listen_socket(config);
+    if (config->idle_timeout_ms > 0)
+    {
+        reactor->timer_fd = timer_socket();
+    }
+    if (reactor->wake_fd < 0 || reactor->listen_fd < 0 ||
+        (config->idle_timeout_ms > 0 && reactor->timer_fd < 0))
+    {
+        reactor_deinitialize(reactor);
+        return false;
+    }
+
+    if (config->backend == REACTOR_BACKEND_IO_URING && reactor_uring_initialize(reactor))
+    {
+        reactor->backend = REACTOR_BACKEND_IO_URING;
+        return true;
+    }
+
+    reactor->backend = REACTOR_BACKEND_EPOLL;
+    reactor->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    reactor->read_buffer = malloc(reactor->read_size);
+    if (reactor->epoll_fd < 0 || reactor->read_buffer == NULL ||
+        !watch(reactor, reactor->listen_fd, EPOLLIN | EPOLLET) ||
+        !watch(reactor, reactor->wake_fd, EPOLLIN) ||
+        (reactor->timer_fd >= 0 && !watch(reactor, reactor->timer_fd, EPOLLIN)))
+    {
+        reactor_deinitialize(reactor);
+        return false;
+    }
+    return true;
+}
+
+void reactor_deinitialize(Reactor* reactor)
+{
+    size_t fd;
+
+    for (fd = 0; fd < reactor->capacity; fd++)
+    {
+        if (reactor->connections[fd])
+        {
+            reactor_close(reactor, reactor->connections[fd]);
+        }
+    }
+    if (reactor->uring)
+    {
+        reactor_uring_deinitialize(reactor);
+    }
+    buffer_pool_deinitialize(&reactor->buffers);
+    free(reactor->connections);
+    free(reactor->read_buffer);
+    if (reactor->listen_fd >= 0) close(reactor->listen_fd);
+    if (reactor->wake_fd >= 0) close(reactor->wake_fd);
+    if (reactor->spare_fd >= 0) close(reactor->spare_fd);
+    if (reactor->timer_fd >= 0) close(reactor->timer_fd);
+    if (reactor->epoll_fd >= 0) close(reactor->epoll_fd);
+    reactor->connections = NULL;
+    reactor->capacity = 0;
+    reactor->read_buffer = NULL;
+    reactor->listen_fd = reactor->wake_fd = reactor->spare_fd = reactor->timer_fd = reactor->epoll_fd = -1;
+}
+
+static bool table_reserve(Reactor* reactor, int fd)
+{
+    size_t new_capacity;
+    ReactorConnection** grown;
+
+    if ((size_t)fd < reactor->capacity)
+    {
+        return true;
+    }
+    new_capacity = reactor->capacity ? reactor->capacity : 64;
+    while (new_capacity <= (size_t)fd)
+    {
+        new_capacity *= 2;
+    }
+    grown = realloc(reactor->connections, new_capacity * sizeof(*grown));
+    if (grown == NULL)
+    {
+        return false;
+    }
+    memset(grown + reactor->capacity, 0, (new_capacity - reactor->capacity) * sizeof(*grown));
+    reactor->connections = grown;
+    reactor->capacity = new_capacity;
+    return true;
+}
+
+ReactorConnection* reactor_add_connection(Reactor* reactor, int fd)
+{
+    ReactorConnection* conn;
+    int one = 1;
+
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    conn = calloc(1, sizeof(*conn));
+    if (conn == NULL || !table_reserve(reactor, fd))
+    {
+        free(conn);
+        close(fd);
+        return NULL;
+    }
+    conn->fd = fd;
+    conn->id = reactor->next_id++;
+    frame_reader_initialize(&conn->frames, reactor->max_frame);
+    frame_reader_use_pool(&conn->frames, &reactor->buffers);
+    if (reactor->next_id == 0)
+    {
+        reactor->next_id = 1;    // 0 marks the listener and wake fd
+    }
+    if (reactor->uring ? !reactor_uring_watch(reactor, conn) :
+                         !watch(reactor, fd, EPOLLIN | EPOLLRDHUP | EPOLLET))
+    {
+        free(conn);
+        close(fd);
+        return NULL;
+    }
+    reactor->connections[fd] = conn;
+    STAT_ADD(reactor->active, 1);
+    STAT_ADD(reactor->accepted, 1);
+    if (reactor->timer_fd >= 0)
+    {
+        reactor_touch(reactor, conn);
+        timer_wheel_schedule(&reactor->timers, &conn->idle, conn->idle_deadline);
+    }
+    if (reactor->on_open)
+    {
+        reactor->on_open(reactor, conn, reactor->ctx);
+    }
+    // NULL if on_open rejected the connection.
+    return reactor->connections[fd];
+}
+
+// Out of fds: accept and drop one client with the spare fd so the accept
+// queue keeps moving instead of spinning on the same edge.
+void reactor_shed_connection(Reactor* reactor)
+{
+    int fd;
+
+    if (reactor->spare_fd < 0)
+    {
+        return;
+    }
+    close(reactor->spare_fd);
+    fd = accept(reactor->listen_fd, NULL, NULL);
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    reactor->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
+
+// Edge-triggered: drain the accept queue, or no new edge will come.
+static void handle_accept(Reactor* reactor)
+{
+    for (;;)
+    {
+        int fd = accept4(reactor->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        reactor->syscalls++;
+        if (fd >= 0)
+        {
+            reactor_add_connection(reactor, fd);
+            continue;
+        }
+        if (errno == EINTR || errno == ECONNABORTED)
+        {
+            continue;
+        }
+        if ((errno == EMFILE || errno == ENFILE) && reactor->spare_fd >= 0)
+        {
+            reactor_shed_connection(reactor);
+            continue;
+        }
+        return;    // EAGAIN, or an error the next edge will retry
+    }
+}
+
+static void output_release(Reactor* reactor, ReactorConnection* conn)
+{
+    if (conn->output_pooled)
+    {
+        buffer_pool_release(&reactor->buffers, conn->output);
+    }
+    else
+    {
+        free(conn->output);
+    }
+    conn->output = NULL;
+    conn->output_head = 0;
+    conn->output_size = 0;
+    conn->output_capacity = 0;
+    conn->output_pooled = false;
+}
+
+void reactor_close(Reactor* reactor, ReactorConnection* conn)
+{
+    int fd = conn->fd;
+
+    if (reactor->on_close)
+    {
+        reactor->on_close(reactor, conn, reactor->ctx);
+    }
+    // close() drops the fd from the epoll set as well. A pending io_uring
+    // recv holds its own file reference, so shut the socket down first to
+    // complete it; its completion no longer matches conn->id.
+    if (reactor->uring)
+    {
+        shutdown(fd, SHUT_RDWR);
+    }
+    close(fd);
+    timer_wheel_cancel(&reactor->timers, &conn->idle);
+    reactor->connections[fd] = NULL;
+    STAT_ADD(reactor->active, -1);
+    STAT_ADD(reactor->closed, 1);
+    frame_reader_deinitialize(&conn->frames);
+    output_release(reactor, conn);
+    while (conn->files)
+    {
+        ReactorFileSend* next = conn->files->next;
+        if (conn->files->close_fd)
+        {
+            close(conn->files->fd);
+        }
+        free(conn->files);
+        conn->files = next;
+    }
+    free(conn);
+}
+
+typedef struct FrameDispatch
+{
+    Reactor* reactor;
+    ReactorConnection* conn;
+    int fd;
+}FrameDispatch;
+
+static bool still_open(const FrameDispatch* d)
+{
+    return d->reactor->connections[d->fd] == d->conn;
+}
+
+static bool dispatch_frame(void* ctx, const void* payload, size_t length)
+{
+    FrameDispatch* d = ctx;
+    Reactor* reactor = d->reactor;
+
+    reactor->on_frame(reactor, d->conn, payload, length, reactor->ctx);
+    STAT_ADD(reactor->frames, 1);
+    latency_histogram_record(&reactor->latency, monotonic_ns() - reactor->arrival_ns);
+    return still_open(d);
+}
+
+static void note_arrival(Reactor* reactor, ReactorConnection* conn, size_t length)
+{
+    reactor_touch(reactor, conn);
+    reactor->arrival_ns = monotonic_ns();
+    STAT_ADD(reactor->bytes_in, length);
+}
+
+void reactor_deliver(Reactor* reactor, ReactorConnection* conn, const void* data, size_t length)
+{
+    FrameDispatch d;
+
+    note_arrival(reactor, conn, length);
+    if (reactor->on_frame == NULL)
+    {
+        if (reactor->on_data)
+        {
+            reactor->on_data(reactor, conn, data, length, reactor->ctx);
+        }
+        return;
+    }
+    d.reactor = reactor;
+    d.conn = conn;
+    d.fd = conn->fd;
+    if (!frame_reader_feed(&conn->frames, data, length, dispatch_frame, &d) && still_open(&d))
+    {
+        reactor_close(reactor, conn);    // oversized frame
+    }
+}
+
+// Edge-triggered: read until EAGAIN. Stops early if the handler closed
+// the connection. While a split frame is pending the rest of it is read
+// straight into the connection's frame ring.
+static void handle_read(Reactor* reactor, int fd)
+{
+    for (;;)
+    {
+        ReactorConnection* conn = reactor->connections[fd];
+        void* space = NULL;
+        size_t space_size = 0;
+        ssize_t n;
+
+        if (conn == NULL)
+        {
+            return;
+        }
+        if (reactor->on_frame)
+        {
+            space = frame_reader_space(&conn->frames, &space_size);
+        }
+        n = space ? recv(fd, space, space_size, 0) : recv(fd, reactor->read_buffer, reactor->read_size, 0);
+        reactor->syscalls++;
+        if (n > 0)
+        {
+            if (space)
+            {
+                FrameDispatch d = { reactor, conn, fd };
+
+                note_arrival(reactor, conn, (size_t)n);
+                if (!frame_reader_commit(&conn->frames, (size_t)n, dispatch_frame, &d) && still_open(&d))
+                {
+                    reactor_close(reactor, conn);
+                }
+            }
+            else
+            {
+                reactor_deliver(reactor, conn, reactor->read_buffer, (size_t)n);
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return;
+        }
+        reactor_close(reactor, conn);    // orderly shutdown or reset
+        return;
+    }
+}
+
+static bool output_reserve(Reactor* reactor, ReactorConnection* conn, size_t length)
+{
+    size_t capacity = conn->output_capacity ? conn->output_capacity : 4096;
+    unsigned char* grown;
+
+    if (conn->output_head + conn->output_size + length <= conn->output_capacity)
+    {
+        return true;
+    }
+    if (conn->output == NULL && length <= reactor->buffers.buffer_size)
+    {
+        conn->output = buffer_pool_acquire(&reactor->buffers);
+        if (conn->output)
+        {
+            conn->output_capacity = reactor->buffers.buffer_size;
+            conn->output_pooled = true;
+            return true;
+        }
+    }
+    // Slide the unsent bytes down before growing.
+    if (conn->output_head > 0)
+    {
+        memmove(conn->output, conn->output + conn->output_head, conn->output_size);
+        conn->output_head = 0;
+        if (conn->output_size + length <= conn->output_capacity)
+        {
+            return true;
+        }
+    }
+    while (capacity < conn->output_size + length)
+    {
+        capacity *= 2;
+    }
+    // Outgrew the pool buffer: move to the heap.
+    grown = conn->output_pooled ? malloc(capacity) : realloc(conn->output, capacity);
+    if (grown == NULL)
+    {
+        return false;
+    }
+    if (conn->output_pooled)
+    {
+        memcpy(grown, conn->output, conn->output_size);
+        buffer_pool_release(&reactor->buffers, conn->output);
+        conn->output_pooled = false;
+    }
+    conn->output = grown;
+    conn->output_capacity = capacity;
+    return true;
+}
+
+static bool set_want_write(Reactor* reactor, ReactorConnection* conn, bool want)
+{
+    if (conn->want_write == want)
+    {
+        return true;
+    }
+    conn->want_write = want;
+    if (reactor->uring)
+    {
+        // POLLOUT is one-shot; nothing to undo once the output drained.
+        return !want || reactor_uring_watch_write(reactor, conn);
+    }
+    return watch_op(reactor, EPOLL_CTL_MOD, conn->fd,
+                    EPOLLIN | EPOLLRDHUP | EPOLLET | (want ? EPOLLOUT : 0));
+}
+
+bool reactor_sendv(Reactor* reactor, ReactorConnection* conn, const struct iovec* iov, int count)
+{
+    size_t total = 0, sent = 0;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        total += iov[i].iov_len;
+    }
+    // Queued output goes first, or the stream would be reordered.
+    if (conn->output_size == 0 && conn->files == NULL)
+    {
+        struct msghdr msg;
+        ssize_t n;
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = (struct iovec*)iov;
+        msg.msg_iovlen = (size_t)count;
+        n = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        {
+            return false;
+        }
+        sent = n > 0 ? (size_t)n : 0;
+        STAT_ADD(reactor->bytes_out, sent);
+        if (sent == total)
+        {
+            return true;
+        }
+    }
+
+    if (!output_reserve(reactor, conn, total - sent))
+    {
+        return false;
+    }
+    for (i = 0; i < count; i++)
+    {
+        size_t skip = sent < iov[i].iov_len ? sent : iov[i].iov_len;
+        memcpy(conn->output + conn->output_head + conn->output_size,
+               (const unsigned char*)iov[i].iov_base + skip, iov[i].iov_len - skip);
+        conn->output_size += iov[i].iov_len - skip;
+        conn->output_queued += iov[i].iov_len - skip;
+        sent -= skip;
+    }
+    return set_want_write(reactor, conn, true);
+}
+
+bool reactor_send(Reactor* reactor, ReactorConnection* conn, const void* data, size_t length)
+{
+    struct iovec iov;
+    iov.iov_base = (void*)data;
+    iov.iov_len = length;
+    return reactor_sendv(reactor, conn, &iov, 1);
+}
+
+// Sends the next piece of queued output: buffered bytes up to the next
+// file, or the next chunk of that file.
+static ssize_t send_next(ReactorConnection* conn)
+{
+    ReactorFileSend* file = conn->files;
+    size_t limit = file ? (size_t)(file->output_mark - conn->output_sent) : conn->output_size;
+    ssize_t n;
+
+    if (limit > 0)
+    {
+        n = send(conn->fd, conn->output + conn->output_head, limit, MSG_NOSIGNAL);
+        if (n > 0)
+        {
+            conn->output_head += (size_t)n;
+            conn->output_size -= (size_t)n;
+            conn->output_sent += (unsigned long long)n;
+        }
+        return n;
+    }
+    n = sendfile(conn->fd, file->fd, &file->offset, file->remaining < (1u << 30) ? file->remaining : (1u << 30));
+    if (n == 0)
+    {
+        errno = EPIPE;    // the file is shorter than promised
+        return -1;
+    }
+    if (n > 0 && (file->remaining -= (size_t)n) == 0)
+    {
+        conn->files = file->next;
+        if (conn->files == NULL)
+        {
+            conn->files_tail = NULL;
+        }
+        if (file->close_fd)
+        {
+            close(file->fd);
+        }
+        free(file);
+    }
+    return n;
+}
+
+// 1 once everything is sent, 0 if the socket is full, -1 on error.
+static int flush_output(Reactor* reactor, ReactorConnection* conn)
+{
+    while (conn->output_size > 0 || conn->files)
+    {
+        ssize_t n = send_next(conn);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+        // A long download is activity too.
+        reactor_touch(reactor, conn);
+        STAT_ADD(reactor->bytes_out, (size_t)n);
+    }
+    output_release(reactor, conn);
+    return 1;
+}
+
+void reactor_handle_write(Reactor* reactor, ReactorConnection* conn)
+{
+    int result = flush_output(reactor, conn);
+
+    if (result == 0)
+    {
+        // Still full: epoll reports the next edge; io_uring needs a fresh
+        // one-shot poll.
+        if (reactor->uring && !reactor_uring_watch_write(reactor, conn))
+        {
+            reactor_close(reactor, conn);
+        }
+        return;
+    }
+    if (result < 0 || !set_want_write(reactor, conn, false))
+    {
+        reactor_close(reactor, conn);
+    }
+}
+
+bool reactor_send_file(Reactor* reactor, ReactorConnection* conn, int file_fd, off_t offset,
+                       size_t length, bool close_file)
+{
+    ReactorFileSend* file;
+    int result;
+
+    if (length == 0)
+    {
+        if (close_file)
+        {
+            close(file_fd);
+        }
+        return true;
+    }
+    file = malloc(sizeof(*file));
+    if (file == NULL)
+    {
+        return false;
+    }
+    file->next = NULL;
+    file->fd = file_fd;
+    file->close_fd = close_file;
+    file->offset = offset;
+    file->remaining = length;
+    file->output_mark = conn->output_queued;
+    if (conn->files_tail)
+    {
+        conn->files_tail->next = file;
+    }
+    else
+    {
+        conn->files = file;
+    }
+    conn->files_tail = file;
+    if (conn->want_write)
+    {
+        return true;    // the write handler gets to it in order
+    }
+    result = flush_output(reactor, conn);
+    if (result > 0 || (result == 0 && set_want_write(reactor, conn, true)))
+    {
+        return true;
+    }
+    // A file is only popped once fully sent, which cannot fail after, so it
+    // is still the tail: hand it back to the caller.
+    if (conn->files == file)
+    {
+        conn->files = NULL;
+        conn->files_tail = NULL;
+    }
+    else
+    {
+        ReactorFileSend* prev = conn->files;
+        while (prev->next != file)
+        {
+            prev = prev->next;
+        }
+        prev->next = NULL;
+        conn->files_tail = prev;
+    }
+    free(file);
+    return false;
+}
+
+void reactor_handle_timer(Reactor* reactor)
+{
+    TimerWheelEntry* expired = timer_wheel_advance(&reactor->timers, current_tick());
+    TimerWheelEntry* idle = NULL;
+
+    // Reads only moved the deadline, so an entry can fire for a connection
+    // that has been busy since; those go back into the wheel.
+    while (expired)
+    {
+        TimerWheelEntry* next = expired->next;
+        ReactorConnection* conn = (ReactorConnection*)((char*)expired - offsetof(ReactorConnection, idle));
+
+        if (conn->idle_deadline > reactor->timers.now)
+        {
+            timer_wheel_schedule(&reactor->timers, expired, conn->idle_deadline);
+        }
+        else
+        {
+            expired->next = idle;
+            idle = expired;
+        }
+        expired = next;
+    }
+    // Closed as one batch once the wheel is consistent again.
+    while (idle)
+    {
+        TimerWheelEntry* next = idle->next;
+        reactor_close(reactor, (ReactorConnection*)((char*)idle - offsetof(ReactorConnection, idle)));
+        STAT_ADD(reactor->timed_out, 1);
+        idle = next;
+    }
+}
+
+int reactor_run(Reactor* reactor)
+{
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+
+    if (reactor->uring)
+    {
+        return reactor_uring_run(reactor);
+    }
+    while (!__atomic_load_n(&reactor->stopping, __ATOMIC_ACQUIRE))
+    {
+        int i, n = epoll_wait(reactor->epoll_fd, events, REACTOR_MAX_EVENTS, -1);
+        reactor->syscalls++;
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        for (i = 0; i < n; i++)
+        {
+            int fd = events[i].data.fd;
+
+            if (fd == reactor->listen_fd)
+            {
+                handle_accept(reactor);
+            }
+            else if (fd == reactor->wake_fd)
+            {
+                uint64_t value;
+                if (read(fd, &value, sizeof(value)) > 0 &&
+                    __atomic_load_n(&reactor->stopping, __ATOMIC_ACQUIRE))
+                {
+                    break;
+                }
+            }
+            else if (fd == reactor->timer_fd)
+            {
+                uint64_t ticks;
+                if (read(fd, &ticks, sizeof(ticks)) > 0)
+                {
+                    reactor_handle_timer(reactor);
+                }
+            }
+            // Looked up by fd, not by pointer: a connection closed earlier
+            // in this batch leaves a NULL entry rather than a dangling one.
+            else if ((size_t)fd < reactor->capacity && reactor->connections[fd])
+            {
+                if (events[i].events & EPOLLOUT)
+                {
+                    reactor_handle_write(reactor, reactor->connections[fd]);
+                }
+                if (events[i].events & ~EPOLLOUT)
+                {
+                    handle_read(reactor, fd);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+void reactor_stop(Reactor* reactor)
+{
+    uint64_t one = 1;
+    ssize_t n;
+
+    __atomic_store_n(&reactor->stopping, true, __ATOMIC_RELEASE);
+    n = write(reactor->wake_fd, &one, sizeof(one));
+    (void)n;
+}
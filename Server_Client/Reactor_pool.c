@@ -0,0 +1,99 @@
+#define _GNU_SOURCE
+#include "reactor_pool.h"
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+bool reactor_pool_initialize(ReactorPool* pool, const ReactorConfig* config, size_t count)
+{
+    ReactorConfig shared = *config;
+    size_t i;
+
+    memset(pool, 0, sizeof(*pool));
+    if (count == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        count = cpus > 0 ? (size_t)cpus : 1;
+    }
+    if (config->port == 0)
+    {
+        return false;
+    }
+    shared.reuse_port = true;
+
+    pool->reactors = calloc(count, sizeof(*pool->reactors));
+    pool->threads = calloc(count, sizeof(*pool->threads));
+    if (pool->reactors == NULL || pool->threads == NULL)
+    {
+        reactor_pool_deinitialize(pool);
+        return false;
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (!reactor_initialize(&pool->reactors[i], &shared))
+        {
+            reactor_pool_deinitialize(pool);
+            return false;
+        }
+        pool->reactors[i].id = (unsigned int)i;
+        pool->count++;
+    }
+    return true;
+}
+
+static void* reactor_thread(void* arg)
+{
+    reactor_run(arg);
+    return NULL;
+}
+
+bool reactor_pool_start(ReactorPool* pool)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (pool->running = 0; pool->running < pool->count; pool->running++)
+    {
+        size_t i = pool->running;
+        cpu_set_t set;
+
+        if (pthread_create(&pool->threads[i], NULL, reactor_thread, &pool->reactors[i]) != 0)
+        {
+            reactor_pool_stop(pool);
+            return false;
+        }
+        CPU_ZERO(&set);
+        CPU_SET(cpus > 0 ? i % (size_t)cpus : 0, &set);
+        pthread_setaffinity_np(pool->threads[i], sizeof(set), &set);
+    }
+    return true;
+}
+
+void reactor_pool_stop(ReactorPool* pool)
+{
+    size_t i;
+
+    for (i = 0; i < pool->running; i++)
+    {
+        reactor_stop(&pool->reactors[i]);
+    }
+    for (i = 0; i < pool->running; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pool->running = 0;
+}
+
+void reactor_pool_deinitialize(ReactorPool* pool)
+{
+    size_t i;
+
+    reactor_pool_stop(pool);
+    for (i = 0; i < pool->count; i++)
+    {
+        reactor_deinitialize(&pool->reactors[i]);
+    }
+    free(pool->reactors);
+    free(pool->threads);
+    memset(pool, 0, sizeof(*pool));
+}
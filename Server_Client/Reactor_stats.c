@@ -0,0 +1,304 @@
+#define _GNU_SOURCE
+#include "reactor_stats.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define REPORT_SIZE    768    // per reactor, plenty for one report
+
+#define LOAD(field)    __atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+void reactor_stats_snapshot(const Reactor* reactor, ReactorStatsSnapshot* snapshot)
+{
+    struct timespec ts;
+    size_t i;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    snapshot->time_ns = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    snapshot->active = LOAD(reactor->active);
+    snapshot->accepted = LOAD(reactor->accepted);
+    snapshot->closed = LOAD(reactor->closed);
+    snapshot->timed_out = LOAD(reactor->timed_out);
+    snapshot->bytes_in = LOAD(reactor->bytes_in);
+    snapshot->bytes_out = LOAD(reactor->bytes_out);
+    snapshot->frames = LOAD(reactor->frames);
+    for (i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        snapshot->latency.counts[i] = LOAD(reactor->latency.counts[i]);
+    }
+    snapshot->latency.count = LOAD(reactor->latency.count);
+    snapshot->latency.max = LOAD(reactor->latency.max);
+}
+
+void reactor_stats_merge(ReactorStatsSnapshot* into, const ReactorStatsSnapshot* from)
+{
+    size_t i;
+
+    into->active += from->active;
+    into->accepted += from->accepted;
+    into->closed += from->closed;
+    into->timed_out += from->timed_out;
+    into->bytes_in += from->bytes_in;
+    into->bytes_out += from->bytes_out;
+    into->frames += from->frames;
+    for (i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        into->latency.counts[i] += from->latency.counts[i];
+    }
+    into->latency.count += from->latency.count;
+    if (from->latency.max > into->latency.max)
+    {
+        into->latency.max = from->latency.max;
+    }
+}
+
+uint64_t reactor_stats_percentile(const LatencyHistogram* latency, double fraction)
+{
+    uint64_t total = 0, seen = 0, wanted;
+    unsigned int i;
+
+    // The buckets are loaded one by one, so sum them rather than trust count.
+    for (i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        total += latency->counts[i];
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+    wanted = (uint64_t)(fraction * (double)total + 0.5);
+    wanted = wanted < 1 ? 1 : wanted > total ? total : wanted;
+    for (i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        seen += latency->counts[i];
+        if (seen >= wanted)
+        {
+            break;
+        }
+    }
+    // The top bucket is open ended; the max is tighter there anyway.
+    return latency_bucket_limit(i) < latency->max ? latency_bucket_limit(i) : latency->max;
+}
+
+int reactor_stats_format(const char* name, const ReactorStatsSnapshot* snapshot,
+                         const ReactorStatsSnapshot* previous, char* out, size_t size)
+{
+    double seconds = previous && snapshot->time_ns > previous->time_ns ?
+                     (double)(snapshot->time_ns - previous->time_ns) / 1e9 : 0;
+    const LatencyHistogram* latency = &snapshot->latency;
+    int length;
+
+    length = snprintf(out, size,
+                      "%s: %llu active, %llu accepted, %llu closed, %llu timed out\n"
+                      "  %llu frames, %llu bytes in, %llu bytes out\n",
+                      name, snapshot->active, snapshot->accepted, snapshot->closed, snapshot->timed_out,
+                      snapshot->frames, snapshot->bytes_in, snapshot->bytes_out);
+    if (seconds > 0 && length >= 0 && (size_t)length < size)
+    {
+        length += snprintf(out + length, size - (size_t)length,
+                           "  last %.1f s: %.1f accepts/s, %.0f frames/s, %.0f B/s in, %.0f B/s out\n",
+                           seconds,
+                           (double)(snapshot->accepted - previous->accepted) / seconds,
+                           (double)(snapshot->frames - previous->frames) / seconds,
+                           (double)(snapshot->bytes_in - previous->bytes_in) / seconds,
+                           (double)(snapshot->bytes_out - previous->bytes_out) / seconds);
+    }
+    if (length >= 0 && (size_t)length < size)
+    {
+        length += snprintf(out + length, size - (size_t)length,
+                           "  latency us: p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, p99.99 %.1f, max %.1f\n",
+                           reactor_stats_percentile(latency, 0.5) / 1e3,
+                           reactor_stats_percentile(latency, 0.9) / 1e3,
+                           reactor_stats_percentile(latency, 0.99) / 1e3,
+                           reactor_stats_percentile(latency, 0.999) / 1e3,
+                           reactor_stats_percentile(latency, 0.9999) / 1e3,
+                           latency->max / 1e3);
+    }
+    return length;
+}
+
+// One report: every reactor, then the total when there are several.
+static void serve_report(ReactorStatsEndpoint* endpoint, int fd)
+{
+    size_t size = (endpoint->count + 1) * REPORT_SIZE, length = 0, i;
+    ReactorStatsSnapshot* total = &endpoint->previous[endpoint->count];
+    ReactorStatsSnapshot* current = malloc(sizeof(*current));
+    ReactorStatsSnapshot* sum = calloc(1, sizeof(*sum));
+    char* report = malloc(size);
+    char name[32];
+
+    if (current == NULL || sum == NULL || report == NULL)
+    {
+        free(current);
+        free(sum);
+        free(report);
+        return;
+    }
+    for (i = 0; i < endpoint->count; i++)
+    {
+        int n;
+
+        reactor_stats_snapshot(&endpoint->reactors[i], current);
+        reactor_stats_merge(sum, current);
+        sum->time_ns = current->time_ns;
+        snprintf(name, sizeof(name), "reactor %u", endpoint->reactors[i].id);
+        n = reactor_stats_format(name, current, endpoint->previous[i].time_ns ? &endpoint->previous[i] : NULL,
+                                 report + length, size - length);
+        length += n > 0 ? (size_t)n : 0;
+        length = length < size ? length : size - 1;
+        endpoint->previous[i] = *current;
+    }
+    if (endpoint->count > 1)
+    {
+        int n = reactor_stats_format("total", sum, total->time_ns ? total : NULL, report + length, size - length);
+        length += n > 0 ? (size_t)n : 0;
+        length = length < size ? length : size - 1;
+    }
+    *total = *sum;
+
+    // The reader is a local tool; a blocking write of a few KiB is fine.
+    for (i = 0; i < length;)
+    {
+        ssize_t n = send(fd, report + i, length - i, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+        i += (size_t)n;
+    }
+    free(current);
+    free(sum);
+    free(report);
+}
+
+static void* endpoint_thread(void* arg)
+{
+    ReactorStatsEndpoint* endpoint = arg;
+    struct pollfd fds[2];
+
+    fds[0].fd = endpoint->listen_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = endpoint->wake_fd;
+    fds[1].events = POLLIN;
+    for (;;)
+    {
+        int fd;
+
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents)
+        {
+            break;
+        }
+        if (!(fds[0].revents & POLLIN))
+        {
+            continue;
+        }
+        fd = accept4(endpoint->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd >= 0)
+        {
+            serve_report(endpoint, fd);
+            close(fd);
+        }
+    }
+    return NULL;
+}
+
+static void endpoint_release(ReactorStatsEndpoint* endpoint)
+{
+    if (endpoint->listen_fd >= 0)
+    {
+        close(endpoint->listen_fd);
+    }
+    if (endpoint->wake_fd >= 0)
+    {
+        close(endpoint->wake_fd);
+    }
+    free(endpoint->previous);
+    endpoint->previous = NULL;
+    endpoint->listen_fd = -1;
+    endpoint->wake_fd = -1;
+}
+
+bool reactor_stats_endpoint_start(ReactorStatsEndpoint* endpoint, const char* path,
+                                  Reactor* reactors, size_t count)
+{
+    struct sockaddr_un addr;
+    struct stat st;
+
+    memset(endpoint, 0, sizeof(*endpoint));
+    endpoint->listen_fd = -1;
+    endpoint->wake_fd = -1;
+    if (strlen(path) >= sizeof(endpoint->path) || strlen(path) >= sizeof(addr.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    strcpy(endpoint->path, path);
+    endpoint->reactors = reactors;
+    endpoint->count = count;
+    endpoint->previous = calloc(count + 1, sizeof(*endpoint->previous));
+    endpoint->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    endpoint->wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (endpoint->previous == NULL || endpoint->listen_fd < 0 || endpoint->wake_fd < 0)
+    {
+        endpoint_release(endpoint);
+        return false;
+    }
+
+    // Only a socket left behind by an earlier run is removed, never a file.
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+    {
+        unlink(path);
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (bind(endpoint->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(endpoint->listen_fd, 16) < 0)
+    {
+        endpoint_release(endpoint);
+        return false;
+    }
+    if (pthread_create(&endpoint->thread, NULL, endpoint_thread, endpoint) != 0)
+    {
+        unlink(path);
+        endpoint_release(endpoint);
+        return false;
+    }
+    return true;
+}
+
+void reactor_stats_endpoint_stop(ReactorStatsEndpoint* endpoint)
+{
+    uint64_t one = 1;
+    ssize_t n;
+
+    if (endpoint->listen_fd < 0)
+    {
+        return;
+    }
+    n = write(endpoint->wake_fd, &one, sizeof(one));
+    (void)n;
+    pthread_join(endpoint->thread, NULL);
+    unlink(endpoint->path);
+    endpoint_release(endpoint);
+}
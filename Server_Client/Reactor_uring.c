@@ -0,0 +1,404 @@
+#define _GNU_SOURCE
+#include "reactor_uring.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+
+// Raw io_uring (no liburing): the rings are mapped directly and driven
+// with io_uring_enter(). Only the reactor thread touches them, and without
+// SQPOLL the kernel reads submissions only inside io_uring_enter(), so the
+// submission tail can be published as soon as an entry is taken.
+
+#define BUFFER_GROUP    0
+#define WRITE_TAG       0x80000000u    // in the fd half of user_data
+
+struct ReactorUring
+{
+    int fd;
+    void* ring_map;
+    size_t ring_map_size;
+    struct io_uring_sqe* sqes;
+    size_t sqes_size;
+
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_array;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned to_submit;
+
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    struct io_uring_cqe* cqes;
+    unsigned cq_mask;
+
+    struct io_uring_buf_ring* buf_ring;
+    size_t buf_ring_size;
+    unsigned char* buffers;
+    unsigned short buf_tail;
+
+    bool multishot_recv;       // cleared if the kernel rejects it (< 6.0)
+    uint64_t wake_value;
+    uint64_t timer_value;
+};
+
+static int uring_enter(ReactorUring* u, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, u->fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static uint64_t user_data(int fd, uint32_t id)
+{
+    return (uint64_t)id << 32 | (uint32_t)fd;
+}
+
+static struct io_uring_sqe* get_sqe(Reactor* reactor)
+{
+    ReactorUring* u = reactor->uring;
+    unsigned tail = *u->sq_tail;
+    unsigned index;
+    struct io_uring_sqe* sqe;
+
+    if (tail - __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE) == u->sq_entries)
+    {
+        int submitted = uring_enter(u, u->to_submit, 0, 0);
+        reactor->syscalls++;
+        if (submitted > 0)
+        {
+            u->to_submit -= (unsigned)submitted;
+        }
+        if (tail - __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE) == u->sq_entries)
+        {
+            return NULL;
+        }
+    }
+    index = tail & u->sq_mask;
+    sqe = &u->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    u->sq_array[index] = index;
+    __atomic_store_n(u->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    u->to_submit++;
+    return sqe;
+}
+
+static bool arm_accept(Reactor* reactor)
+{
+    struct io_uring_sqe* sqe = get_sqe(reactor);
+    if (sqe == NULL)
+    {
+        return false;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = reactor->listen_fd;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = user_data(reactor->listen_fd, 0);
+    return true;
+}
+
+static bool arm_wake(Reactor* reactor)
+{
+    struct io_uring_sqe* sqe = get_sqe(reactor);
+    if (sqe == NULL)
+    {
+        return false;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = reactor->wake_fd;
+    sqe->addr = (uintptr_t)&reactor->uring->wake_value;
+    sqe->len = sizeof(reactor->uring->wake_value);
+    sqe->user_data = user_data(reactor->wake_fd, 0);
+    return true;
+}
+
+static bool arm_timer(Reactor* reactor)
+{
+    struct io_uring_sqe* sqe = get_sqe(reactor);
+    if (sqe == NULL)
+    {
+        return false;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = reactor->timer_fd;
+    sqe->addr = (uintptr_t)&reactor->uring->timer_value;
+    sqe->len = sizeof(reactor->uring->timer_value);
+    sqe->user_data = user_data(reactor->timer_fd, 0);
+    return true;
+}
+
+// The kernel picks a buffer from the group when data arrives, so idle
+// connections hold no buffer at all.
+bool reactor_uring_watch(Reactor* reactor, ReactorConnection* conn)
+{
+    struct io_uring_sqe* sqe = get_sqe(reactor);
+    if (sqe == NULL)
+    {
+        return false;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = conn->fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->ioprio = reactor->uring->multishot_recv ? IORING_RECV_MULTISHOT : 0;
+    sqe->user_data = user_data(conn->fd, conn->id);
+    return true;
+}
+
+bool reactor_uring_watch_write(Reactor* reactor, ReactorConnection* conn)
+{
+    struct io_uring_sqe* sqe = get_sqe(reactor);
+    if (sqe == NULL)
+    {
+        return false;
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = conn->fd;
+    sqe->poll32_events = POLLOUT;
+    sqe->user_data = user_data((int)((uint32_t)conn->fd | WRITE_TAG), conn->id);
+    return true;
+}
+
+static void recycle_buffer(ReactorUring* u, unsigned short bid)
+{
+    struct io_uring_buf* buf = &u->buf_ring->bufs[u->buf_tail & (REACTOR_URING_BUFFERS - 1)];
+
+    buf->addr = (uintptr_t)(u->buffers + (size_t)bid * REACTOR_URING_BUFFER_SIZE);
+    buf->len = REACTOR_URING_BUFFER_SIZE;
+    buf->bid = bid;
+    u->buf_tail++;
+    __atomic_store_n(&u->buf_ring->tail, u->buf_tail, __ATOMIC_RELEASE);
+}
+
+bool reactor_uring_initialize(Reactor* reactor)
+{
+    struct io_uring_params params;
+    struct io_uring_buf_reg reg;
+    ReactorUring* u;
+    size_t sq_size, cq_size;
+    unsigned short i;
+
+    u = calloc(1, sizeof(*u));
+    if (u == NULL)
+    {
+        return false;
+    }
+    u->fd = -1;
+    u->ring_map = MAP_FAILED;
+    u->sqes = MAP_FAILED;
+    u->buf_ring = MAP_FAILED;
+    u->multishot_recv = true;
+    reactor->uring = u;
+
+    memset(&params, 0, sizeof(params));
+    u->fd = (int)syscall(__NR_io_uring_setup, REACTOR_URING_ENTRIES, &params);
+    if (u->fd < 0 || !(params.features & IORING_FEAT_SINGLE_MMAP))
+    {
+        reactor_uring_deinitialize(reactor);
+        return false;
+    }
+
+    sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    u->ring_map_size = sq_size > cq_size ? sq_size : cq_size;
+    u->ring_map = mmap(NULL, u->ring_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       u->fd, IORING_OFF_SQ_RING);
+    u->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   u->fd, IORING_OFF_SQES);
+    if (u->ring_map == MAP_FAILED || u->sqes == MAP_FAILED)
+    {
+        reactor_uring_deinitialize(reactor);
+        return false;
+    }
+    u->sq_head = (unsigned*)((char*)u->ring_map + params.sq_off.head);
+    u->sq_tail = (unsigned*)((char*)u->ring_map + params.sq_off.tail);
+    u->sq_array = (unsigned*)((char*)u->ring_map + params.sq_off.array);
+    u->sq_mask = *(unsigned*)((char*)u->ring_map + params.sq_off.ring_mask);
+    u->sq_entries = params.sq_entries;
+    u->cq_head = (unsigned*)((char*)u->ring_map + params.cq_off.head);
+    u->cq_tail = (unsigned*)((char*)u->ring_map + params.cq_off.tail);
+    u->cqes = (struct io_uring_cqe*)((char*)u->ring_map + params.cq_off.cqes);
+    u->cq_mask = *(unsigned*)((char*)u->ring_map + params.cq_off.ring_mask);
+
+    // Provided buffer ring (5.19+; multishot accept came in the same release).
+    u->buf_ring_size = REACTOR_URING_BUFFERS * sizeof(struct io_uring_buf);
+    u->buf_ring = mmap(NULL, u->buf_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    u->buffers = aligned_alloc(4096, (size_t)REACTOR_URING_BUFFERS * REACTOR_URING_BUFFER_SIZE);
+    if (u->buf_ring == MAP_FAILED || u->buffers == NULL)
+    {
+        reactor_uring_deinitialize(reactor);
+        return false;
+    }
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uintptr_t)u->buf_ring;
+    reg.ring_entries = REACTOR_URING_BUFFERS;
+    reg.bgid = BUFFER_GROUP;
+    if (syscall(__NR_io_uring_register, u->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        reactor_uring_deinitialize(reactor);
+        return false;
+    }
+    for (i = 0; i < REACTOR_URING_BUFFERS; i++)
+    {
+        recycle_buffer(u, i);
+    }
+
+    if (!arm_accept(reactor) || !arm_wake(reactor) ||
+        (reactor->timer_fd >= 0 && !arm_timer(reactor)))
+    {
+        reactor_uring_deinitialize(reactor);
+        return false;
+    }
+    return true;
+}
+
+void reactor_uring_deinitialize(Reactor* reactor)
+{
+    ReactorUring* u = reactor->uring;
+
+    if (u == NULL)
+    {
+        return;
+    }
+    // Closing the ring cancels everything still in flight.
+    if (u->fd >= 0) close(u->fd);
+    if (u->ring_map != MAP_FAILED) munmap(u->ring_map, u->ring_map_size);
+    if (u->sqes != MAP_FAILED) munmap(u->sqes, u->sqes_size);
+    if (u->buf_ring != MAP_FAILED) munmap(u->buf_ring, u->buf_ring_size);
+    free(u->buffers);
+    free(u);
+    reactor->uring = NULL;
+}
+
+static void handle_accept(Reactor* reactor, const struct io_uring_cqe* cqe)
+{
+    if (cqe->res >= 0)
+    {
+        reactor_add_connection(reactor, cqe->res);
+    }
+    else if (cqe->res == -EMFILE || cqe->res == -ENFILE)
+    {
+        reactor_shed_connection(reactor);
+    }
+    if (!(cqe->flags & IORING_CQE_F_MORE))
+    {
+        arm_accept(reactor);
+    }
+}
+
+static void handle_recv(Reactor* reactor, const struct io_uring_cqe* cqe)
+{
+    ReactorUring* u = reactor->uring;
+    int fd = (int)(uint32_t)cqe->user_data;
+    uint32_t id = (uint32_t)(cqe->user_data >> 32);
+    ReactorConnection* conn = (size_t)fd < reactor->capacity ? reactor->connections[fd] : NULL;
+    bool current = conn && conn->id == id;
+
+    if (cqe->flags & IORING_CQE_F_BUFFER)
+    {
+        unsigned short bid = (unsigned short)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        if (current && cqe->res > 0)
+        {
+            reactor_deliver(reactor, conn, u->buffers + (size_t)bid * REACTOR_URING_BUFFER_SIZE,
+                            (size_t)cqe->res);
+        }
+        recycle_buffer(u, bid);
+    }
+
+    // Late completion for a connection that has been closed; the handler
+    // may also have closed it just now.
+    if (!current || reactor->connections[fd] != conn)
+    {
+        return;
+    }
+    if (cqe->res == -EINVAL && u->multishot_recv)
+    {
+        u->multishot_recv = false;    // re-armed single-shot below
+    }
+    else if (cqe->res == 0 || (cqe->res < 0 && cqe->res != -ENOBUFS))
+    {
+        reactor_close(reactor, conn);
+        return;
+    }
+    // Multishot ends on ENOBUFS (all buffers in use) or single-shot mode.
+    if (!(cqe->flags & IORING_CQE_F_MORE) && !reactor_uring_watch(reactor, conn))
+    {
+        reactor_close(reactor, conn);
+    }
+}
+
+static void handle_writable(Reactor* reactor, const struct io_uring_cqe* cqe)
+{
+    int fd = (int)((uint32_t)cqe->user_data & ~WRITE_TAG);
+    uint32_t id = (uint32_t)(cqe->user_data >> 32);
+    ReactorConnection* conn = (size_t)fd < reactor->capacity ? reactor->connections[fd] : NULL;
+
+    if (conn && conn->id == id && conn->want_write)
+    {
+        reactor_handle_write(reactor, conn);
+    }
+}
+
+int reactor_uring_run(Reactor* reactor)
+{
+    ReactorUring* u = reactor->uring;
+
+    while (!__atomic_load_n(&reactor->stopping, __ATOMIC_ACQUIRE))
+    {
+        unsigned head, tail;
+        int submitted = uring_enter(u, u->to_submit, 1, IORING_ENTER_GETEVENTS);
+
+        reactor->syscalls++;
+        if (submitted < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+            {
+                continue;
+            }
+            return -1;
+        }
+        u->to_submit -= (unsigned)submitted < u->to_submit ? (unsigned)submitted : u->to_submit;
+
+        head = *u->cq_head;
+        tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++)
+        {
+            const struct io_uring_cqe* cqe = &u->cqes[head & u->cq_mask];
+            int fd = (int)(uint32_t)cqe->user_data;
+            bool internal = (cqe->user_data >> 32) == 0;
+
+            if (internal && fd == reactor->listen_fd)
+            {
+                handle_accept(reactor, cqe);
+            }
+            else if (internal && fd == reactor->wake_fd)
+            {
+                arm_wake(reactor);
+            }
+            else if (internal && fd == reactor->timer_fd)
+            {
+                reactor_handle_timer(reactor);
+                arm_timer(reactor);
+            }
+            else if ((uint32_t)cqe->user_data & WRITE_TAG)
+            {
+                handle_writable(reactor, cqe);
+            }
+            else
+            {
+                handle_recv(reactor, cqe);
+            }
+        }
+        // Entries are consumed in place, so the kernel may reuse them only
+        // after the whole batch.
+        __atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+    }
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include "server_events.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_QUEUE_CAPACITY    4096
+
+bool server_events_initialize(ServerEvents* events, const ServerEventsConfig* config)
+{
+    size_t capacity = config->queue_capacity ? config->queue_capacity : DEFAULT_QUEUE_CAPACITY;
+
+    memset(events, 0, sizeof(*events));
+    event_initialize_concurrent(&events->event);
+    events->async = config->workers > 0;
+    if (!events->async)
+    {
+        return true;
+    }
+
+    // One single-threaded dispatcher per worker rather than one shared
+    // pool, so that every connection has a fixed worker.
+    events->dispatchers = calloc(config->workers, sizeof(*events->dispatchers));
+    if (events->dispatchers == NULL)
+    {
+        event_deinitialize(&events->event);
+        return false;
+    }
+    for (; events->dispatcher_count < config->workers; events->dispatcher_count++)
+    {
+        if (!event_dispatcher_initialize(&events->dispatchers[events->dispatcher_count],
+                                         capacity, 1, config->policy))
+        {
+            server_events_deinitialize(events);
+            return false;
+        }
+    }
+    return true;
+}
+
+void server_events_deinitialize(ServerEvents* events)
+{
+    size_t i;
+
+    for (i = 0; i < events->dispatcher_count; i++)
+    {
+        event_dispatcher_deinitialize(&events->dispatchers[i]);
+    }
+    free(events->dispatchers);
+    events->dispatchers = NULL;
+    events->dispatcher_count = 0;
+    event_deinitialize(&events->event);
+}
+
+static void publish(ServerEvents* events, ServerEvent* event, const void* data, size_t length)
+{
+    EventDispatcher* dispatcher;
+    EventAsyncSlot slot;
+
+    if (!events->async)
+    {
+        event->data = data;
+        event_notify(&events->event, event, sizeof(*event));
+        return;
+    }
+
+    // The worker gets a copy, so the frame travels inside the payload and
+    // nothing points back into the reactor. Both are written straight into
+    // the queue cell.
+    event->data = NULL;
+    event->reactor = NULL;
+    event->conn = NULL;
+    dispatcher = &events->dispatchers[(event->reactor_id + event->connection_id) % events->dispatcher_count];
+    if (!event_async_reserve(dispatcher, &events->event, sizeof(*event) + length,
+                             event->header.type != SERVER_EVENT_MESSAGE, &slot))
+    {
+        __atomic_fetch_add(&events->handoff_failures, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    memcpy(slot.data, event, sizeof(*event));
+    if (length > 0)
+    {
+        memcpy((unsigned char*)slot.data + sizeof(*event), data, length);
+    }
+    event_async_commit(dispatcher, &slot);
+}
+
+static void describe(ServerEvent* event, ServerEventType type, Reactor* reactor,
+                     ReactorConnection* conn, size_t length)
+{
+    event->header.type = type;
+    event->reactor_id = reactor->id;
+    event->connection_id = conn->id;
+    event->fd = conn->fd;
+    event->length = (uint32_t)length;
+    event->reactor = reactor;
+    event->conn = conn;
+}
+
+static void on_open(Reactor* reactor, ReactorConnection* conn, void* ctx)
+{
+    ServerEvent event;
+    describe(&event, SERVER_EVENT_OPENED, reactor, conn, 0);
+    publish(ctx, &event, NULL, 0);
+}
+
+static void on_frame(Reactor* reactor, ReactorConnection* conn, const void* data, size_t length, void* ctx)
+{
+    ServerEvent event;
+    describe(&event, SERVER_EVENT_MESSAGE, reactor, conn, length);
+    publish(ctx, &event, data, length);
+}
+
+static void on_close(Reactor* reactor, ReactorConnection* conn, void* ctx)
+{
+    ServerEvent event;
+    describe(&event, SERVER_EVENT_CLOSED, reactor, conn, 0);
+    publish(ctx, &event, NULL, 0);
+}
+
+void server_events_attach(ServerEvents* events, ReactorConfig* config)
+{
+    config->on_open = on_open;
+    config->on_frame = on_frame;
+    config->on_close = on_close;
+    config->ctx = events;
+}
+
+EventHandle server_events_subscribe(ServerEvents* events, uint32_t types,
+                                    EventContextHandler handler, void* ctx)
+{
+    EventSubscribeOptions options = { 0 };
+    options.filter_mask = types;
+    return event_subscribe_ctx_opts(&events->event, handler, ctx, &options);
+}
+
+void server_events_get_stats(ServerEvents* events, ServerEventsStats* stats)
+{
+    EventDispatchStats worker;
+    size_t i;
+
+    memset(stats, 0, sizeof(*stats));
+    for (i = 0; i < events->dispatcher_count; i++)
+    {
+        event_dispatcher_get_stats(&events->dispatchers[i], &worker);
+        stats->dispatch.depth += worker.depth;
+        stats->dispatch.enqueued += worker.enqueued;
+        stats->dispatch.dispatched += worker.dispatched;
+        stats->dispatch.dropped += worker.dropped;
+        stats->dispatch.queue_total_ns += worker.queue_total_ns;
+        stats->dispatch.latency_total_ns += worker.latency_total_ns;
+        if (worker.queue_max_ns > stats->dispatch.queue_max_ns)
+        {
+            stats->dispatch.queue_max_ns = worker.queue_max_ns;
+        }
+        if (worker.latency_max_ns > stats->dispatch.latency_max_ns)
+        {
+            stats->dispatch.latency_max_ns = worker.latency_max_ns;
+        }
+    }
+    stats->handoff_failures = __atomic_load_n(&events->handoff_failures, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,138 @@
+/*
+ * Linux build of the multi-client server in Server.c. Uses the epoll
+ * reactor (Reactor.c) instead of select() over a fixed array of five
+ * clients, so it serves as many clients as the fd limit allows.
+ *
+ * With more than one reactor every reactor thread gets its own
+ * SO_REUSEPORT listener (Reactor_pool.c).
+ *
+ * Clients send length-prefixed frames (frame.h). Connections and frames
+ * are published through the Event API (Server_events.c); the handlers
+ * below are ordinary subscribers. With workers > 0 they run on a worker
+ * pool instead of the reactor threads. Clients silent for five minutes
+ * are disconnected.
+ *
+ * Counters and frame latency percentiles for every reactor are served on a
+ * Unix socket (Reactor_stats.c): socat - UNIX-CONNECT:/tmp/server.stats
+ *
+ * Build: gcc -O2 -pthread Reactor.c Reactor_uring.c Frame.c Buffer_pool.c Timer_wheel.c Reactor_pool.c Server_events.c
+ *        Reactor_stats.c ../Event_Notifier/Event_notifier.c ../Event_Notifier/Event_dispatcher.c Server_linux.c -o server
+ * Usage: ./server [port] [reactors] [epoll|uring] [workers] [stats socket]     reactors 0 = one per CPU
+ */
+
+#include "reactor_pool.h"
+#include "reactor_stats.h"
+#include "server_events.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PORT 9999
+#define IDLE_TIMEOUT_MS (5 * 60 * 1000)
+#define STATS_SOCKET "/tmp/server.stats"
+
+static ReactorPool pool;
+static ServerEvents events;
+static ReactorStatsEndpoint stats_endpoint;
+
+static void HandleConnection(const Event* e, const void* data, size_t length, void* ctx)
+{
+    const ServerEvent* event = data;
+    (void)e; (void)length; (void)ctx;
+    printf("\nClient %d %s", event->fd, event->header.type == SERVER_EVENT_OPENED ? "connected" : "disconnected");
+}
+
+static void HandleDataFromClient(const Event* e, const void* data, size_t length, void* ctx)
+{
+    const ServerEvent* event = data;
+    (void)e; (void)length; (void)ctx;
+    printf("\nReceived data from:%d[Message:%.*s]", event->fd, (int)event->length,
+           (const char*)server_event_data(event));
+}
+
+int main(int argc, char* argv[])
+{
+    ReactorConfig config = { 0 };
+    ServerEventsConfig events_config = { 0 };
+    ServerEventsStats stats;
+    ReactorStatsSnapshot *total, *snapshot;
+    char report[1024];
+    sigset_t signals;
+    size_t i;
+    int signo;
+
+    // Blocked before the reactor and worker threads start so they inherit the mask
+    // and only the sigwait() below ever sees SIGINT/SIGTERM.
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    config.port = argc > 1 ? (uint16_t)atoi(argv[1]) : PORT;
+    config.idle_timeout_ms = IDLE_TIMEOUT_MS;
+    events_config.workers = argc > 4 ? strtoul(argv[4], NULL, 10) : 0;
+    events_config.policy = EVENT_BACKPRESSURE_BLOCK;
+    if (!server_events_initialize(&events, &events_config))
+    {
+        perror("\nCannot start the event workers");
+        return (EXIT_FAILURE);
+    }
+    server_events_subscribe(&events, SERVER_EVENT_OPENED | SERVER_EVENT_CLOSED, HandleConnection, NULL);
+    server_events_subscribe(&events, SERVER_EVENT_MESSAGE, HandleDataFromClient, NULL);
+    server_events_attach(&events, &config);
+    config.backend = argc > 3 && strcmp(argv[3], "uring") == 0 ? REACTOR_BACKEND_IO_URING
+                                                              : REACTOR_BACKEND_EPOLL;
+    if (!reactor_pool_initialize(&pool, &config, argc > 2 ? strtoul(argv[2], NULL, 10) : 1))
+    {
+        perror("\nThe server cannot be started");
+        server_events_deinitialize(&events);
+        return (EXIT_FAILURE);
+    }
+
+    printf("\nListening on port %u with %zu %s reactor(s)", config.port, pool.count,
+           pool.reactors[0].backend == REACTOR_BACKEND_IO_URING ? "io_uring" : "epoll");
+    fflush(stdout);
+    if (!reactor_pool_start(&pool))
+    {
+        perror("\nCannot start the reactor threads");
+        reactor_pool_deinitialize(&pool);
+        server_events_deinitialize(&events);
+        return (EXIT_FAILURE);
+    }
+    if (!reactor_stats_endpoint_start(&stats_endpoint, argc > 5 ? argv[5] : STATS_SOCKET, pool.reactors, pool.count))
+    {
+        perror("\nNo stats socket");
+    }
+    sigwait(&signals, &signo);
+    reactor_stats_endpoint_stop(&stats_endpoint);
+    reactor_pool_stop(&pool);
+
+    // Snapshots are about 9 KiB each (the latency histogram).
+    total = calloc(1, sizeof(*total));
+    snapshot = malloc(sizeof(*snapshot));
+    if (total && snapshot)
+    {
+        for (i = 0; i < pool.count; i++)
+        {
+            reactor_stats_snapshot(&pool.reactors[i], snapshot);
+            reactor_stats_merge(total, snapshot);
+        }
+        reactor_stats_format("\nserved", total, NULL, report, sizeof(report));
+        fputs(report, stdout);
+    }
+    free(total);
+    free(snapshot);
+    reactor_pool_deinitialize(&pool);
+    server_events_get_stats(&events, &stats);
+    if (events.async && stats.dispatch.dispatched > 0)
+    {
+        printf("%llu events handed off, queue time avg %.1f us max %.1f us, %llu dropped\n",
+               stats.dispatch.dispatched,
+               stats.dispatch.queue_total_ns / 1e3 / stats.dispatch.dispatched,
+               stats.dispatch.queue_max_ns / 1e3, stats.dispatch.dropped + stats.handoff_failures);
+    }
+    server_events_deinitialize(&events);
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include "timer_wheel.h"
+#include <string.h>
+
+#define SLOT_MASK     (TIMER_WHEEL_SLOTS - 1)
+#define MAX_DELTA     ((1ull << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+void timer_wheel_initialize(TimerWheel* wheel, uint64_t now)
+{
+    memset(wheel, 0, sizeof(*wheel));
+    wheel->now = now;
+}
+
+static void link_entry(TimerWheel* wheel, TimerWheelEntry* entry)
+{
+    uint64_t delta = entry->expires - wheel->now;
+    uint64_t when = entry->expires;
+    TimerWheelEntry** slot;
+    int level;
+
+    if (delta > MAX_DELTA)
+    {
+        delta = MAX_DELTA;
+        when = wheel->now + MAX_DELTA;
+    }
+    // Level l holds what expires within 64^(l+1) ticks, in the slot picked
+    // by the l-th group of 6 bits of the expiry tick.
+    for (level = 0; level < TIMER_WHEEL_LEVELS - 1; level++)
+    {
+        if (delta < 1ull << (TIMER_WHEEL_BITS * (level + 1)))
+        {
+            break;
+        }
+    }
+    slot = &wheel->slots[level][(when >> (TIMER_WHEEL_BITS * level)) & SLOT_MASK];
+
+    entry->next = *slot;
+    if (entry->next)
+    {
+        entry->next->pprev = &entry->next;
+    }
+    entry->pprev = slot;
+    *slot = entry;
+}
+
+static void unlink_entry(TimerWheelEntry* entry)
+{
+    *entry->pprev = entry->next;
+    if (entry->next)
+    {
+        entry->next->pprev = entry->pprev;
+    }
+    entry->next = NULL;
+    entry->pprev = NULL;
+}
+
+void timer_wheel_schedule(TimerWheel* wheel, TimerWheelEntry* entry, uint64_t expires)
+{
+    if (entry->pprev)
+    {
+        unlink_entry(entry);
+    }
+    else
+    {
+        wheel->count++;
+    }
+    entry->expires = expires > wheel->now ? expires : wheel->now + 1;
+    link_entry(wheel, entry);
+}
+
+void timer_wheel_cancel(TimerWheel* wheel, TimerWheelEntry* entry)
+{
+    if (entry->pprev)
+    {
+        unlink_entry(entry);
+        wheel->count--;
+    }
+}
+
+// Re-places every entry of one upper-level slot; they all land in a lower
+// level now that they are closer. Returns the slot index so the caller
+// knows whether this level wrapped as well.
+static unsigned int cascade(TimerWheel* wheel, int level)
+{
+    unsigned int index = (unsigned int)(wheel->now >> (TIMER_WHEEL_BITS * level)) & SLOT_MASK;
+    TimerWheelEntry* entry = wheel->slots[level][index];
+
+    wheel->slots[level][index] = NULL;
+    while (entry)
+    {
+        TimerWheelEntry* next = entry->next;
+        link_entry(wheel, entry);
+        entry = next;
+    }
+    return index;
+}
+
+TimerWheelEntry* timer_wheel_advance(TimerWheel* wheel, uint64_t now)
+{
+    TimerWheelEntry* expired = NULL;
+
+    while (wheel->now < now)
+    {
+        TimerWheelEntry* entry;
+        unsigned int index;
+        int level;
+
+        if (wheel->count == 0)
+        {
+            wheel->now = now;
+            break;
+        }
+        wheel->now++;
+        index = (unsigned int)wheel->now & SLOT_MASK;
+        for (level = 1; index == 0 && level < TIMER_WHEEL_LEVELS; level++)
+        {
+            index = cascade(wheel, level);
+        }
+
+        entry = wheel->slots[0][wheel->now & SLOT_MASK];
+        wheel->slots[0][wheel->now & SLOT_MASK] = NULL;
+        while (entry)
+        {
+            TimerWheelEntry* next = entry->next;
+
+            entry->pprev = NULL;
+            entry->next = expired;
+            expired = entry;
+            wheel->count--;
+            entry = next;
+        }
+    }
+    return expired;
+}
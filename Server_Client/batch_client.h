@@ -0,0 +1,101 @@
+#ifndef BATCH_CLIENT_H
+#define BATCH_CLIENT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+#include "frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Pipelining client for the framed server protocol (frame.h). Messages
+// are queued as frames and written in batches with one writev() per batch
+// (up to IOV_MAX segments) instead of one send() each. A batch goes out
+// when it reaches batch_bytes, when its oldest message is batch_us old
+// (checked on every queue call and by batch_client_poll()), or on
+// batch_client_flush(). TCP_NODELAY is always set: the batching replaces
+// Nagle, so a batch never waits on a delayed ACK.
+//
+// In low_latency mode every message is written as soon as it is queued.
+//
+// One thread may queue/flush while another receives.
+//
+// A failed write leaves the stream in an unknown state: the queued frames
+// are dropped and every later queue/flush fails with EPIPE.
+
+#define BATCH_CLIENT_DEFAULT_BYTES    65536
+#define BATCH_CLIENT_DEFAULT_US       200
+#define BATCH_CLIENT_COPY_LIMIT       512    // smaller payloads are copied
+
+typedef struct BatchClientConfig
+{
+    const char* address;       // dotted IPv4, NULL = 127.0.0.1
+    uint16_t port;
+    size_t batch_bytes;        // 0 = BATCH_CLIENT_DEFAULT_BYTES
+    unsigned int batch_us;     // 0 = BATCH_CLIENT_DEFAULT_US
+    bool low_latency;
+    size_t max_frame;          // for received frames, 0 = default
+}BatchClientConfig;
+
+// A queued piece of the stream: either bytes in the client's arena
+// (data == NULL) or a caller-owned payload.
+typedef struct BatchSegment
+{
+    const void* data;
+    size_t offset;
+    size_t length;
+}BatchSegment;
+
+typedef struct BatchClient
+{
+    int fd;
+    size_t batch_bytes;
+    unsigned long long batch_ns;
+    bool low_latency;
+
+    unsigned char* arena;      // headers and copied payloads
+    size_t arena_size;
+    size_t arena_capacity;
+    BatchSegment* segments;
+    size_t segment_count;
+    size_t segment_capacity;
+    struct iovec* iov;         // scratch for writev()
+    size_t queued_bytes;
+    unsigned long long oldest_ns;
+    bool failed;               // a write failed; the stream is unusable
+
+    FrameReader frames;        // receive side
+    unsigned char* read_buffer;
+
+    unsigned long long messages;
+    unsigned long long batches;
+    unsigned long long bytes;
+}BatchClient;
+
+bool batch_client_connect(BatchClient* client, const BatchClientConfig* config);
+void batch_client_close(BatchClient* client);
+
+// Queues one frame; the payload is copied. Returns false on a write error.
+bool batch_client_queue(BatchClient* client, const void* data, size_t length);
+// Like batch_client_queue(), but payloads of BATCH_CLIENT_COPY_LIMIT bytes
+// or more are referenced instead of copied and must stay valid until the
+// next flush returns.
+bool batch_client_queue_ref(BatchClient* client, const void* data, size_t length);
+// Writes everything queued; blocks until the kernel took all of it.
+bool batch_client_flush(BatchClient* client);
+// Flushes if the oldest queued message has waited batch_us. For callers
+// that stop queueing for a while.
+bool batch_client_poll(BatchClient* client);
+
+// Blocks for one read and passes every complete frame to handler.
+// Returns false on EOF, error or a protocol error.
+bool batch_client_receive(BatchClient* client, FrameHandler handler, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BATCH_CLIENT_H
@@ -0,0 +1,326 @@
+/*
+ * Memory benchmark for the connection buffer pool (Buffer_pool.c).
+ *
+ * Allocation rate under churn:
+ *  slots     a random live set of [live] 64 KiB buffers, each step frees
+ *            or takes one and writes to it: BufferPool vs malloc/free
+ *  readers   connection churn as the server sees it: a FrameReader is
+ *            created, receives one frame split in two and is torn down,
+ *            with its ring taken from a pool vs mapped per connection
+ *
+ * Resident memory per idle connection: forks an epoll reactor server,
+ * opens [connections] clients and reads the server's RSS from /proc,
+ * first with the connections idle, then again once every client has sent
+ * one 1 KiB frame split across two writes (in groups of 64, so only a few
+ * are in flight at a time). Run with and without the pool; without it
+ * every connection that ever saw a split frame keeps its own ring.
+ *
+ * Build: gcc -O2 Reactor.c Reactor_uring.c Frame.c Buffer_pool.c Timer_wheel.c bench_buffers.c -o bench_buffers
+ * Usage: ./bench_buffers [connections] [live]
+ */
+
+#define _GNU_SOURCE
+#include "reactor.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#define BENCH_PORT      9992
+#define BUFFER_SIZE     BUFFER_POOL_DEFAULT_SIZE
+#define CHURN_STEPS     4000000
+#define READER_CYCLES   20000
+#define FRAME_SIZE      1024
+#define GROUP           64
+
+static Reactor reactor;
+static bool use_pool;
+static unsigned long long frames;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool count_frame(void* ctx, const void* payload, size_t length)
+{
+    (void)ctx; (void)payload; (void)length;
+    frames++;
+    return true;
+}
+
+static void churn_slots(size_t live)
+{
+    void** slots = calloc(live, sizeof(*slots));
+    BufferPool pool;
+    double start, pool_time, malloc_time;
+    size_t i, slot;
+
+    buffer_pool_initialize(&pool, BUFFER_SIZE, 0, false);
+    srand(7);
+    start = now_s();
+    for (i = 0; i < CHURN_STEPS; i++)
+    {
+        slot = (size_t)rand() % live;
+        if (slots[slot])
+        {
+            buffer_pool_release(&pool, slots[slot]);
+            slots[slot] = NULL;
+        }
+        else
+        {
+            slots[slot] = buffer_pool_acquire(&pool);
+            ((unsigned char*)slots[slot])[64] = (unsigned char)i;
+        }
+    }
+    pool_time = now_s() - start;
+    printf("slots    pool   %12.0f ops/s   %zu buffers carved for %zu slots\n",
+           CHURN_STEPS / pool_time, pool.buffers, live);
+    buffer_pool_deinitialize(&pool);
+    memset(slots, 0, live * sizeof(*slots));
+
+    srand(7);
+    start = now_s();
+    for (i = 0; i < CHURN_STEPS; i++)
+    {
+        slot = (size_t)rand() % live;
+        if (slots[slot])
+        {
+            free(slots[slot]);
+            slots[slot] = NULL;
+        }
+        else
+        {
+            slots[slot] = malloc(BUFFER_SIZE);
+            ((unsigned char*)slots[slot])[64] = (unsigned char)i;
+        }
+    }
+    malloc_time = now_s() - start;
+    printf("slots    malloc %12.0f ops/s\n", CHURN_STEPS / malloc_time);
+    for (i = 0; i < live; i++)
+    {
+        free(slots[i]);
+    }
+    free(slots);
+}
+
+static void churn_readers(void)
+{
+    unsigned char frame[FRAME_HEADER_SIZE + FRAME_SIZE] = { 0 };
+    BufferPool pool;
+    int pooled;
+
+    frame_write_header(frame, FRAME_SIZE);
+    buffer_pool_initialize(&pool, 0, 0, true);
+    for (pooled = 1; pooled >= 0; pooled--)
+    {
+        double start = now_s(), elapsed;
+        size_t i;
+
+        for (i = 0; i < READER_CYCLES; i++)
+        {
+            FrameReader reader;
+
+            frame_reader_initialize(&reader, 0);
+            if (pooled)
+            {
+                frame_reader_use_pool(&reader, &pool);
+            }
+            frame_reader_feed(&reader, frame, sizeof(frame) / 2, count_frame, NULL);
+            frame_reader_feed(&reader, frame + sizeof(frame) / 2, sizeof(frame) - sizeof(frame) / 2,
+                              count_frame, NULL);
+            frame_reader_deinitialize(&reader);
+        }
+        elapsed = now_s() - start;
+        printf("readers  %-6s %12.0f connections/s\n", pooled ? "pool" : "mapped", READER_CYCLES / elapsed);
+    }
+    buffer_pool_deinitialize(&pool);
+}
+
+static void sink(Reactor* r, ReactorConnection* conn, const void* data, size_t length, void* ctx)
+{
+    (void)r; (void)conn; (void)data; (void)length; (void)ctx;
+    frames++;
+}
+
+static void on_open(Reactor* r, ReactorConnection* conn, void* ctx)
+{
+    (void)r; (void)ctx;
+    if (!use_pool)
+    {
+        frame_reader_use_pool(&conn->frames, NULL);
+    }
+}
+
+static void on_signal(int signo)
+{
+    (void)signo;
+    reactor_stop(&reactor);
+}
+
+static int run_server(int report_pipe)
+{
+    ReactorConfig config = { 0 };
+    unsigned long long report[3];
+
+    config.address = "127.0.0.1";
+    config.port = BENCH_PORT;
+    config.on_frame = sink;
+    config.on_open = on_open;
+    frames = 0;
+    if (!reactor_initialize(&reactor, &config))
+    {
+        perror("reactor_initialize");
+        return 1;
+    }
+    signal(SIGTERM, on_signal);
+    report[0] = 0;
+    if (write(report_pipe, report, sizeof(report[0])) != sizeof(report[0]))
+    {
+        return 1;
+    }
+    reactor_run(&reactor);
+    report[0] = frames;
+    report[1] = reactor.buffers.buffers;
+    report[2] = reactor.buffers.acquired;
+    if (write(report_pipe, report, sizeof(report)) != sizeof(report))
+    {
+        return 1;
+    }
+    reactor_deinitialize(&reactor);
+    return 0;
+}
+
+static long resident_bytes(pid_t pid)
+{
+    char path[64];
+    long size, resident = -1;
+    FILE* f;
+
+    snprintf(path, sizeof(path), "/proc/%d/statm", (int)pid);
+    f = fopen(path, "r");
+    if (f)
+    {
+        if (fscanf(f, "%ld %ld", &size, &resident) != 2)
+        {
+            resident = -1;
+        }
+        fclose(f);
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+static void run_idle(bool pooled, size_t connections)
+{
+    unsigned char frame[FRAME_HEADER_SIZE + FRAME_SIZE] = { 0 };
+    unsigned long long report[3];
+    struct sockaddr_in srv;
+    long base, idle, after;
+    int pipe_fds[2], status, *fds;
+    pid_t child;
+    size_t i, j, opened;
+
+    use_pool = pooled;
+    if (pipe(pipe_fds) < 0)
+    {
+        return;
+    }
+    fflush(stdout);
+    child = fork();
+    if (child == 0)
+    {
+        close(pipe_fds[0]);
+        exit(run_server(pipe_fds[1]));
+    }
+    close(pipe_fds[1]);
+    if (read(pipe_fds[0], report, sizeof(report[0])) != sizeof(report[0]))
+    {
+        waitpid(child, &status, 0);
+        close(pipe_fds[0]);
+        return;
+    }
+    usleep(100000);
+    base = resident_bytes(child);
+
+    memset(&srv, 0, sizeof(srv));
+    srv.sin_family = AF_INET;
+    srv.sin_port = htons(BENCH_PORT);
+    srv.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    fds = calloc(connections, sizeof(*fds));
+    for (opened = 0; opened < connections; opened++)
+    {
+        fds[opened] = socket(AF_INET, SOCK_STREAM, 0);
+        if (fds[opened] < 0 || connect(fds[opened], (struct sockaddr*)&srv, sizeof(srv)) < 0)
+        {
+            perror("connect");
+            if (fds[opened] >= 0)
+            {
+                close(fds[opened]);
+            }
+            break;
+        }
+    }
+    usleep(300000);
+    idle = resident_bytes(child);
+
+    frame_write_header(frame, FRAME_SIZE);
+    for (i = 0; i < opened; i += GROUP)
+    {
+        for (j = i; j < opened && j < i + GROUP; j++)
+        {
+            if (send(fds[j], frame, sizeof(frame) / 2, 0) < 0)
+            {
+                perror("send");
+            }
+        }
+        usleep(2000);
+        for (j = i; j < opened && j < i + GROUP; j++)
+        {
+            if (send(fds[j], frame + sizeof(frame) / 2, sizeof(frame) - sizeof(frame) / 2, 0) < 0)
+            {
+                perror("send");
+            }
+        }
+        usleep(2000);
+    }
+    usleep(300000);
+    after = resident_bytes(child);
+
+    kill(child, SIGTERM);
+    if (read(pipe_fds[0], report, sizeof(report)) == sizeof(report))
+    {
+        printf("%-7s %6zu connections  idle %6.0f B/conn  after one split frame each %7.0f B/conn"
+               "  (%llu frames, %llu pool buffers, %llu acquired)\n",
+               pooled ? "pool" : "mapped", opened,
+               (double)(idle - base) / opened, (double)(after - base) / opened,
+               report[0], report[1], report[2]);
+    }
+    for (i = 0; i < opened; i++)
+    {
+        close(fds[i]);
+    }
+    waitpid(child, &status, 0);
+    close(pipe_fds[0]);
+    free(fds);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t connections = argc > 1 ? strtoul(argv[1], NULL, 10) : 5000;
+    size_t live = argc > 2 ? strtoul(argv[2], NULL, 10) : 4096;
+
+    signal(SIGPIPE, SIG_IGN);
+    churn_slots(live);
+    churn_readers();
+    run_idle(true, connections);
+    run_idle(false, connections);
+    return 0;
+}
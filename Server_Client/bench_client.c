@@ -0,0 +1,296 @@
+/*
+ * Pipelining benchmark for the batching client (Batch_client.c).
+ *
+ * Forks a single-reactor echo server that sends every frame straight back
+ * with reactor_sendv(). [connections] clients then pipeline 64-byte
+ * messages at it for [seconds], each with a sender and a receiver thread
+ * and at most [window] messages in flight per connection. Every message
+ * carries its send time, so the receiver can record the round trip.
+ *
+ * Two runs: low-latency mode (one writev per message) and batched mode
+ * (64 KiB / 200 us thresholds). The table shows messages per second and
+ * the p50/p99 round trip for each.
+ *
+ * Build: gcc -O2 -pthread Reactor.c Reactor_uring.c Frame.c Buffer_pool.c Timer_wheel.c Batch_client.c bench_client.c -o bench_client
+ * Usage: ./bench_client [connections] [seconds] [window]
+ */
+
+#define _GNU_SOURCE
+#include "batch_client.h"
+#include "reactor.h"
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#define BENCH_PORT      9995
+#define MESSAGE_SIZE    64
+#define BUCKETS         100000    // 1 us each; the last one collects the rest
+
+typedef struct Connection
+{
+    BatchClient client;
+    pthread_t sender;
+    pthread_t receiver;
+    pthread_mutex_t lock;
+    pthread_cond_t drained;
+    unsigned long long sent;
+    unsigned long long received;
+    unsigned long long* histogram;
+}Connection;
+
+static Reactor reactor;
+static unsigned long long window;
+static volatile int running;
+
+static unsigned long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+}
+
+static void echo(Reactor* r, ReactorConnection* conn, const void* data, size_t length, void* ctx)
+{
+    unsigned char header[FRAME_HEADER_SIZE];
+    struct iovec iov[2];
+    (void)ctx;
+
+    frame_write_header(header, (uint32_t)length);
+    iov[0].iov_base = header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = (void*)data;
+    iov[1].iov_len = length;
+    if (!reactor_sendv(r, conn, iov, 2))
+    {
+        reactor_close(r, conn);
+    }
+}
+
+static void on_signal(int signo)
+{
+    (void)signo;
+    reactor_stop(&reactor);
+}
+
+static int run_server(int ready_pipe)
+{
+    ReactorConfig config = { 0 };
+    char ready = 1;
+
+    config.address = "127.0.0.1";
+    config.port = BENCH_PORT;
+    config.on_frame = echo;
+    if (!reactor_initialize(&reactor, &config))
+    {
+        perror("reactor_initialize");
+        return 1;
+    }
+    signal(SIGTERM, on_signal);
+    if (write(ready_pipe, &ready, 1) != 1)
+    {
+        return 1;
+    }
+    reactor_run(&reactor);
+    reactor_deinitialize(&reactor);
+    return 0;
+}
+
+static bool on_echo(void* ctx, const void* payload, size_t length)
+{
+    Connection* c = ctx;
+    unsigned long long stamp, rtt;
+
+    if (length < sizeof(stamp))
+    {
+        return false;
+    }
+    memcpy(&stamp, payload, sizeof(stamp));
+    rtt = (now_ns() - stamp) / 1000;
+    c->histogram[rtt < BUCKETS ? rtt : BUCKETS - 1]++;
+    __atomic_store_n(&c->received, c->received + 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+static void* receiver(void* arg)
+{
+    Connection* c = arg;
+
+    while (batch_client_receive(&c->client, on_echo, c))
+    {
+        pthread_mutex_lock(&c->lock);
+        pthread_cond_signal(&c->drained);
+        pthread_mutex_unlock(&c->lock);
+    }
+    // EOF: wake the sender in case it is waiting on the window.
+    pthread_mutex_lock(&c->lock);
+    running = 0;
+    pthread_cond_signal(&c->drained);
+    pthread_mutex_unlock(&c->lock);
+    return NULL;
+}
+
+static void* sender(void* arg)
+{
+    Connection* c = arg;
+    unsigned char message[MESSAGE_SIZE] = { 0 };
+
+    while (running)
+    {
+        unsigned long long stamp;
+
+        if (c->sent - __atomic_load_n(&c->received, __ATOMIC_RELAXED) >= window)
+        {
+            // Whatever is queued has to go out before the window can open.
+            if (!batch_client_flush(&c->client))
+            {
+                break;
+            }
+            pthread_mutex_lock(&c->lock);
+            while (running && c->sent - __atomic_load_n(&c->received, __ATOMIC_RELAXED) >= window)
+            {
+                pthread_cond_wait(&c->drained, &c->lock);
+            }
+            pthread_mutex_unlock(&c->lock);
+            continue;
+        }
+        stamp = now_ns();
+        memcpy(message, &stamp, sizeof(stamp));
+        if (!batch_client_queue(&c->client, message, sizeof(message)))
+        {
+            break;
+        }
+        c->sent++;
+    }
+    batch_client_flush(&c->client);
+    return NULL;
+}
+
+static unsigned long long percentile(const unsigned long long* histogram, unsigned long long total, double p)
+{
+    unsigned long long seen = 0, target = (unsigned long long)(total * p);
+    size_t i;
+
+    for (i = 0; i < BUCKETS; i++)
+    {
+        seen += histogram[i];
+        if (seen > target)
+        {
+            return i;
+        }
+    }
+    return BUCKETS;
+}
+
+static void run(const char* name, bool low_latency, size_t connections, double seconds)
+{
+    BatchClientConfig config = { 0 };
+    Connection* conns = calloc(connections, sizeof(*conns));
+    unsigned long long* histogram = calloc(BUCKETS, sizeof(*histogram));
+    unsigned long long received = 0, messages = 0, batches = 0, start;
+    size_t i, j, opened;
+
+    config.port = BENCH_PORT;
+    config.low_latency = low_latency;
+    running = 1;
+    for (opened = 0; opened < connections; opened++)
+    {
+        Connection* c = &conns[opened];
+        if (!batch_client_connect(&c->client, &config))
+        {
+            perror("connect");
+            break;
+        }
+        c->histogram = calloc(BUCKETS, sizeof(*c->histogram));
+        pthread_mutex_init(&c->lock, NULL);
+        pthread_cond_init(&c->drained, NULL);
+    }
+
+    start = now_ns();
+    for (i = 0; i < opened; i++)
+    {
+        pthread_create(&conns[i].receiver, NULL, receiver, &conns[i]);
+        pthread_create(&conns[i].sender, NULL, sender, &conns[i]);
+    }
+    usleep((useconds_t)(seconds * 1e6));
+    running = 0;
+    for (i = 0; i < opened; i++)
+    {
+        Connection* c = &conns[i];
+
+        pthread_mutex_lock(&c->lock);
+        pthread_cond_signal(&c->drained);
+        pthread_mutex_unlock(&c->lock);
+        pthread_join(c->sender, NULL);
+        // Unblocks the receiver's recv().
+        shutdown(c->client.fd, SHUT_RDWR);
+        pthread_join(c->receiver, NULL);
+    }
+    seconds = (now_ns() - start) / 1e9;
+
+    for (i = 0; i < opened; i++)
+    {
+        Connection* c = &conns[i];
+
+        received += c->received;
+        messages += c->client.messages;
+        batches += c->client.batches;
+        for (j = 0; j < BUCKETS; j++)
+        {
+            histogram[j] += c->histogram[j];
+        }
+        batch_client_close(&c->client);
+        pthread_mutex_destroy(&c->lock);
+        pthread_cond_destroy(&c->drained);
+        free(c->histogram);
+    }
+    printf("%-12s %12.0f msgs/s %8.1f msgs/writev   p50 %6llu us   p99 %6llu us\n",
+           name, received / seconds, batches ? (double)messages / batches : 0.0,
+           percentile(histogram, received, 0.50), percentile(histogram, received, 0.99));
+    free(histogram);
+    free(conns);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t connections = argc > 1 ? strtoul(argv[1], NULL, 10) : 4;
+    double seconds = argc > 2 ? atof(argv[2]) : 2.0;
+    int ready_pipe[2], status;
+    pid_t child;
+    char ready;
+
+    window = argc > 3 ? strtoull(argv[3], NULL, 10) : 256;
+    signal(SIGPIPE, SIG_IGN);
+    if (pipe(ready_pipe) < 0)
+    {
+        return 1;
+    }
+    fflush(stdout);
+    child = fork();
+    if (child == 0)
+    {
+        close(ready_pipe[0]);
+        exit(run_server(ready_pipe[1]));
+    }
+    close(ready_pipe[1]);
+    if (read(ready_pipe[0], &ready, 1) != 1)
+    {
+        waitpid(child, &status, 0);
+        return 1;
+    }
+
+    printf("%zu connections, %d-byte messages, window %llu, %.1f s\n",
+           connections, MESSAGE_SIZE, window, seconds);
+    run("low-latency", true, connections, seconds);
+    run("batched", false, connections, seconds);
+
+    kill(child, SIGTERM);
+    waitpid(child, &status, 0);
+    close(ready_pipe[0]);
+    return 0;
+}
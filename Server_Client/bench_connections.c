@@ -0,0 +1,289 @@
+/*
+ * Loopback load generator for the epoll reactor.
+ *
+ * Forks a child that runs the reactor with an echo handler, then opens up
+ * to [connections] loopback clients from the parent (the two processes
+ * split the fd limit). With the clients connected and idle, one client
+ * does ping-pong round trips; the round-trip time stays flat as the idle
+ * population grows because the loop only visits ready sockets.
+ *
+ * Build: gcc -O2 Reactor.c Reactor_uring.c Frame.c Buffer_pool.c Timer_wheel.c bench_connections.c -o bench_connections
+ * Usage: ./bench_connections [connections] [round_trips]
+ */
+
+#define _GNU_SOURCE
+#include "reactor.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#define BENCH_PORT    9998
+
+static Reactor reactor;
+
+static unsigned long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void echo(Reactor* r, ReactorConnection* conn, const void* data, size_t length, void* ctx)
+{
+    (void)r; (void)ctx;
+    if (send(conn->fd, data, length, MSG_NOSIGNAL) < 0)
+    {
+        reactor_close(r, conn);
+    }
+}
+
+static void on_signal(int signo)
+{
+    (void)signo;
+    reactor_stop(&reactor);
+}
+
+static void raise_fd_limit(void)
+{
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+static int run_server(int ready_pipe)
+{
+    ReactorConfig config = { 0 };
+    char ok = 1;
+
+    config.address = "127.0.0.1";
+    config.port = BENCH_PORT;
+    config.on_data = echo;
+    if (!reactor_initialize(&reactor, &config))
+    {
+        perror("reactor_initialize");
+        return 1;
+    }
+    signal(SIGTERM, on_signal);
+    if (write(ready_pipe, &ok, 1) != 1)
+    {
+        return 1;
+    }
+    reactor_run(&reactor);
+    fprintf(stderr, "server: accepted %llu, active at exit %zu\n", reactor.accepted, reactor.active);
+    reactor_deinitialize(&reactor);
+    return 0;
+}
+
+static int connect_one(const struct sockaddr_in* srv)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (connect(fd, (const struct sockaddr*)srv, sizeof(*srv)) < 0 && errno != EINPROGRESS)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Opens count connections with up to 512 connects in flight. Returns how
+// many fds were stored in fds; fewer than count means a connect failed.
+static size_t open_clients(int* fds, size_t count, const struct sockaddr_in* srv)
+{
+    struct epoll_event events[512];
+    int ep = epoll_create1(0);
+    size_t started = 0, pending = 0, done = 0;
+
+    while (done < count)
+    {
+        int i, n;
+        while (started < count && pending < 512)
+        {
+            struct epoll_event ev;
+            int fd = connect_one(srv);
+            if (fd < 0)
+            {
+                close(ep);
+                return started;
+            }
+            ev.events = EPOLLOUT;
+            ev.data.u64 = started;
+            epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+            fds[started++] = fd;
+            pending++;
+        }
+        n = epoll_wait(ep, events, 512, 1000);
+        if (n <= 0)
+        {
+            close(ep);
+            return started;
+        }
+        for (i = 0; i < n; i++)
+        {
+            int fd = fds[events[i].data.u64];
+            int error = 0;
+            socklen_t len = sizeof(error);
+
+            epoll_ctl(ep, EPOLL_CTL_DEL, fd, NULL);
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len);
+            if (error)
+            {
+                fprintf(stderr, "connect: %s\n", strerror(error));
+                close(ep);
+                return started;
+            }
+            pending--;
+            done++;
+        }
+    }
+    close(ep);
+    return done;
+}
+
+static int compare_ull(const void* a, const void* b)
+{
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void ping_pong(int fd, size_t round_trips, size_t idle)
+{
+    unsigned long long* rtt = malloc(round_trips * sizeof(*rtt));
+    char message[64] = "ping", reply[64];
+    int one = 1;
+    size_t i;
+
+    // Blocking is simpler for a strict request/response loop.
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    for (i = 0; i < round_trips; i++)
+    {
+        unsigned long long start = now_ns();
+        size_t got = 0;
+
+        if (send(fd, message, sizeof(message), 0) != sizeof(message))
+        {
+            break;
+        }
+        while (got < sizeof(reply))
+        {
+            ssize_t n = recv(fd, reply + got, sizeof(reply) - got, 0);
+            if (n <= 0)
+            {
+                break;
+            }
+            got += (size_t)n;
+        }
+        if (got < sizeof(reply))
+        {
+            break;
+        }
+        rtt[i] = now_ns() - start;
+    }
+    if (i > 0)
+    {
+        qsort(rtt, i, sizeof(*rtt), compare_ull);
+        printf("%6zu idle  %8zu round trips  p50 %7llu ns  p99 %7llu ns\n",
+               idle, i, rtt[i / 2], rtt[i * 99 / 100]);
+    }
+    free(rtt);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t connections = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000;
+    size_t round_trips = argc > 2 ? strtoul(argv[2], NULL, 10) : 20000;
+    size_t steps[] = { 0, 100, 1000, 10000, 100000 };
+    struct sockaddr_in srv;
+    int pipe_fds[2], status, ping, *fds;
+    size_t opened = 0, s;
+    pid_t child;
+    char ok;
+
+    raise_fd_limit();
+    signal(SIGPIPE, SIG_IGN);
+    if (pipe(pipe_fds) < 0)
+    {
+        return 1;
+    }
+    fflush(stdout);
+    child = fork();
+    if (child == 0)
+    {
+        close(pipe_fds[0]);
+        return run_server(pipe_fds[1]);
+    }
+    close(pipe_fds[1]);
+    if (read(pipe_fds[0], &ok, 1) != 1)
+    {
+        fprintf(stderr, "server failed to start\n");
+        waitpid(child, &status, 0);
+        return 1;
+    }
+
+    memset(&srv, 0, sizeof(srv));
+    srv.sin_family = AF_INET;
+    srv.sin_port = htons(BENCH_PORT);
+    srv.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    fds = malloc((connections + 1) * sizeof(*fds));
+    if (open_clients(&ping, 1, &srv) != 1)
+    {
+        fprintf(stderr, "cannot connect to the server\n");
+        ping = -1;
+    }
+    for (s = 0; s < sizeof(steps) / sizeof(steps[0]) && ping >= 0; s++)
+    {
+        size_t target = steps[s] < connections ? steps[s] : connections;
+        if (target > opened)
+        {
+            unsigned long long start = now_ns();
+            size_t added = open_clients(fds + opened, target - opened, &srv);
+            double seconds = (now_ns() - start) / 1e9;
+            opened += added;
+            printf("opened %zu connections in %.3f s (%.0f conn/s)\n",
+                   added, seconds, added / seconds);
+            if (opened < target)
+            {
+                fprintf(stderr, "stopped at %zu connections (fd limit?)\n", opened);
+            }
+        }
+        ping_pong(ping, round_trips, opened);
+        if (target == connections || opened < target)
+        {
+            break;
+        }
+    }
+
+    for (s = 0; s < opened; s++)
+    {
+        close(fds[s]);
+    }
+    if (ping >= 0)
+    {
+        close(ping);
+    }
+    free(fds);
+    kill(child, SIGTERM);
+    waitpid(child, &status, 0);
+    return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * Parser benchmark for the length-prefixed framing layer (Frame.c).
+ *
+ * Builds a stream of frames of one size in memory and "receives" it in
+ * chunks of random size (1 byte to 64 KiB), modelling recv() as a memcpy
+ * out of the stream, into
+ *
+ *  ring      the reactor's path: recv into a read buffer and pass whole
+ *            frames as views into it; while a split frame is pending,
+ *            recv straight into the FrameReader's mirrored ring
+ *  linear    the usual copying parser: recv into a read buffer, append it
+ *            to a linear buffer, cut frames out of that and memmove the
+ *            remainder down
+ *
+ * for 64-byte, 1 KiB and 64 KiB frames. The handler reads the first and
+ * last byte of each payload so the view has to be valid.
+ *
+ * Build: gcc -O2 Frame.c Buffer_pool.c bench_frames.c -o bench_frames
+ * Usage: ./bench_frames [stream_MiB] [passes]
+ */
+
+#include "frame.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_CHUNK    65536
+
+typedef struct LinearParser
+{
+    unsigned char* buffer;
+    size_t size;
+    size_t capacity;
+}LinearParser;
+
+static unsigned long long checksum;
+// Read through a volatile so neither parser gets the handler inlined.
+static FrameHandler volatile frame_handler;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool touch(void* ctx, const void* payload, size_t length)
+{
+    const unsigned char* p = payload;
+    (void)ctx;
+    checksum += length ? p[0] + p[length - 1] : 0;
+    return true;
+}
+
+static void linear_feed(LinearParser* parser, const unsigned char* data, size_t length,
+                        FrameHandler handler)
+{
+    size_t offset = 0;
+
+    if (parser->size + length > parser->capacity)
+    {
+        while (parser->size + length > parser->capacity)
+        {
+            parser->capacity = parser->capacity ? parser->capacity * 2 : 65536;
+        }
+        parser->buffer = realloc(parser->buffer, parser->capacity);
+    }
+    memcpy(parser->buffer + parser->size, data, length);
+    parser->size += length;
+
+    while (parser->size - offset >= FRAME_HEADER_SIZE)
+    {
+        size_t frame = frame_read_header(parser->buffer + offset);
+        if (parser->size - offset - FRAME_HEADER_SIZE < frame)
+        {
+            break;
+        }
+        handler(NULL, parser->buffer + offset + FRAME_HEADER_SIZE, frame);
+        offset += FRAME_HEADER_SIZE + frame;
+    }
+    memmove(parser->buffer, parser->buffer + offset, parser->size - offset);
+    parser->size -= offset;
+}
+
+static void run(size_t frame_size, size_t stream_bytes, size_t* chunks, size_t chunk_count, int passes)
+{
+    size_t per_frame = FRAME_HEADER_SIZE + frame_size;
+    size_t frames = stream_bytes / per_frame;
+    size_t length = frames * per_frame;
+    unsigned char* stream = malloc(length);
+    unsigned char* read_buffer = malloc(MAX_CHUNK);
+    FrameHandler handler = frame_handler;
+    double ring_time = 0, linear_time = 0, start;
+    size_t i, offset;
+    int pass;
+
+    for (i = 0; i < frames; i++)
+    {
+        frame_write_header(stream + i * per_frame, (uint32_t)frame_size);
+        memset(stream + i * per_frame + FRAME_HEADER_SIZE, (int)i, frame_size);
+    }
+
+    for (pass = 0; pass < passes; pass++)
+    {
+        FrameReader reader;
+        LinearParser linear = { 0 };
+
+        frame_reader_initialize(&reader, 0);
+        start = now_s();
+        for (offset = 0, i = 0; offset < length; i = (i + 1) % chunk_count)
+        {
+            size_t chunk = chunks[i] < length - offset ? chunks[i] : length - offset;
+            size_t space;
+            void* ring = frame_reader_space(&reader, &space);
+
+            if (ring)
+            {
+                chunk = chunk < space ? chunk : space;
+                memcpy(ring, stream + offset, chunk);
+                frame_reader_commit(&reader, chunk, handler, NULL);
+            }
+            else
+            {
+                memcpy(read_buffer, stream + offset, chunk);
+                frame_reader_feed(&reader, read_buffer, chunk, handler, NULL);
+            }
+            offset += chunk;
+        }
+        ring_time += now_s() - start;
+        frame_reader_deinitialize(&reader);
+
+        start = now_s();
+        for (offset = 0, i = 0; offset < length; offset += chunks[i], i = (i + 1) % chunk_count)
+        {
+            size_t chunk = chunks[i] < length - offset ? chunks[i] : length - offset;
+            memcpy(read_buffer, stream + offset, chunk);
+            linear_feed(&linear, read_buffer, chunk, handler);
+        }
+        linear_time += now_s() - start;
+        free(linear.buffer);
+    }
+
+    printf("%7zu B  ring %12.0f frames/s %6.2f GB/s   linear %12.0f frames/s %6.2f GB/s\n",
+           frame_size,
+           frames * passes / ring_time, length * (double)passes / ring_time / 1e9,
+           frames * passes / linear_time, length * (double)passes / linear_time / 1e9);
+    free(read_buffer);
+    free(stream);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t stream_bytes = (argc > 1 ? strtoul(argv[1], NULL, 10) : 256) << 20;
+    int passes = argc > 2 ? atoi(argv[2]) : 4;
+    size_t sizes[] = { 64, 1024, 65536 };
+    size_t chunks[4096];
+    size_t i;
+
+    frame_handler = touch;
+    srand(42);
+    for (i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++)
+    {
+        chunks[i] = 1 + (size_t)rand() % MAX_CHUNK;
+    }
+    printf("%zu MiB stream, %d passes, chunks of 1..%d bytes\n", stream_bytes >> 20, passes, MAX_CHUNK);
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        run(sizes[i], stream_bytes, chunks, sizeof(chunks) / sizeof(chunks[0]), passes);
+    }
+    printf("checksum %llu\n", checksum);
+    return 0;
+}
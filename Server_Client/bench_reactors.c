@@ -0,0 +1,277 @@
+/*
+ * Scaling benchmark for the multi-reactor server.
+ *
+ * For 1, 2, 4, ... up to [max_reactors] reactors, forks an echo server
+ * built on Reactor_pool.c and drives it from as many client threads as
+ * there are reactors:
+ *
+ *  conn/s   each client connects, does one 1-byte echo and closes (RST,
+ *           so the run doesn't exhaust ephemeral ports in TIME_WAIT)
+ *  msgs/s   each client keeps one 64-byte message in flight on each of
+ *           [connections] connections
+ *
+ * Clients and server share the machine, so numbers flatten once the
+ * client threads need the cores too.
+ *
+ * Build: gcc -O2 -pthread Reactor.c Reactor_uring.c Frame.c Buffer_pool.c Timer_wheel.c Reactor_pool.c bench_reactors.c -o bench_reactors
+ * Usage: ./bench_reactors [max_reactors] [seconds] [connections]
+ */
+
+#define _GNU_SOURCE
+#include "reactor_pool.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#define BENCH_PORT      9997
+#define MESSAGE_SIZE    64
+
+typedef struct ClientThread
+{
+    pthread_t thread;
+    size_t connections;
+    unsigned long long connects;
+    unsigned long long messages;
+}ClientThread;
+
+static struct sockaddr_in srv;
+static pthread_barrier_t barrier;
+static double seconds;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void echo(Reactor* r, ReactorConnection* conn, const void* data, size_t length, void* ctx)
+{
+    (void)ctx;
+    if (send(conn->fd, data, length, MSG_NOSIGNAL) < 0)
+    {
+        reactor_close(r, conn);
+    }
+}
+
+static int run_server(size_t reactors, int ready_pipe)
+{
+    ReactorConfig config = { 0 };
+    ReactorPool pool;
+    sigset_t signals;
+    int signo;
+    char ok = 1;
+
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    config.address = "127.0.0.1";
+    config.port = BENCH_PORT;
+    config.on_data = echo;
+    if (!reactor_pool_initialize(&pool, &config, reactors) || !reactor_pool_start(&pool))
+    {
+        perror("reactor pool");
+        return 1;
+    }
+    if (write(ready_pipe, &ok, 1) != 1)
+    {
+        return 1;
+    }
+    sigwait(&signals, &signo);
+    reactor_pool_deinitialize(&pool);
+    return 0;
+}
+
+static int connect_blocking(void)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0), one = 1;
+    struct linger linger = { 1, 0 };
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+    if (connect(fd, (struct sockaddr*)&srv, sizeof(srv)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void connect_phase(ClientThread* self)
+{
+    double deadline = now_s() + seconds;
+    char byte = 'x';
+
+    while (now_s() < deadline)
+    {
+        int fd = connect_blocking();
+        if (fd < 0)
+        {
+            continue;
+        }
+        if (send(fd, &byte, 1, 0) == 1 && recv(fd, &byte, 1, 0) == 1)
+        {
+            self->connects++;
+        }
+        close(fd);
+    }
+}
+
+static void message_phase(ClientThread* self)
+{
+    struct epoll_event events[256];
+    char message[MESSAGE_SIZE] = { 0 };
+    size_t* received = calloc(self->connections, sizeof(*received));
+    int* fds = calloc(self->connections, sizeof(*fds));
+    int ep = epoll_create1(0);
+    double deadline;
+    size_t i;
+
+    for (i = 0; i < self->connections; i++)
+    {
+        struct epoll_event ev;
+        fds[i] = connect_blocking();
+        ev.events = EPOLLIN;
+        ev.data.u64 = i;
+        epoll_ctl(ep, EPOLL_CTL_ADD, fds[i], &ev);
+    }
+    pthread_barrier_wait(&barrier);
+
+    deadline = now_s() + seconds;
+    for (i = 0; i < self->connections; i++)
+    {
+        send(fds[i], message, sizeof(message), 0);
+    }
+    while (now_s() < deadline)
+    {
+        int e, n = epoll_wait(ep, events, 256, 100);
+        for (e = 0; e < n; e++)
+        {
+            size_t c = events[e].data.u64;
+            char reply[MESSAGE_SIZE * 4];
+            ssize_t got = recv(fds[c], reply, sizeof(reply), MSG_DONTWAIT);
+            if (got <= 0)
+            {
+                continue;
+            }
+            received[c] += (size_t)got;
+            while (received[c] >= MESSAGE_SIZE)
+            {
+                received[c] -= MESSAGE_SIZE;
+                self->messages++;
+                send(fds[c], message, sizeof(message), 0);
+            }
+        }
+    }
+
+    for (i = 0; i < self->connections; i++)
+    {
+        close(fds[i]);
+    }
+    close(ep);
+    free(fds);
+    free(received);
+}
+
+static void* client_thread(void* arg)
+{
+    ClientThread* self = arg;
+
+    pthread_barrier_wait(&barrier);
+    connect_phase(self);
+    pthread_barrier_wait(&barrier);
+    message_phase(self);
+    return NULL;
+}
+
+static void run(size_t reactors, size_t connections)
+{
+    ClientThread* clients = calloc(reactors, sizeof(*clients));
+    unsigned long long connects = 0, messages = 0;
+    int pipe_fds[2], status;
+    pid_t child;
+    size_t i;
+    char ok;
+
+    if (pipe(pipe_fds) < 0)
+    {
+        return;
+    }
+    fflush(stdout);
+    child = fork();
+    if (child == 0)
+    {
+        close(pipe_fds[0]);
+        exit(run_server(reactors, pipe_fds[1]));
+    }
+    close(pipe_fds[1]);
+    if (read(pipe_fds[0], &ok, 1) != 1)
+    {
+        waitpid(child, &status, 0);
+        close(pipe_fds[0]);
+        free(clients);
+        return;
+    }
+    close(pipe_fds[0]);
+
+    pthread_barrier_init(&barrier, NULL, (unsigned int)reactors);
+    for (i = 0; i < reactors; i++)
+    {
+        clients[i].connections = connections;
+        pthread_create(&clients[i].thread, NULL, client_thread, &clients[i]);
+    }
+    for (i = 0; i < reactors; i++)
+    {
+        pthread_join(clients[i].thread, NULL);
+        connects += clients[i].connects;
+        messages += clients[i].messages;
+    }
+    pthread_barrier_destroy(&barrier);
+
+    kill(child, SIGTERM);
+    waitpid(child, &status, 0);
+    printf("%8zu %14.0f %14.0f\n", reactors, connects / seconds, messages / seconds);
+    free(clients);
+}
+
+int main(int argc, char* argv[])
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_reactors = argc > 1 ? strtoul(argv[1], NULL, 10) : (size_t)(cpus > 0 ? cpus : 1);
+    size_t connections = argc > 3 ? strtoul(argv[3], NULL, 10) : 64;
+    size_t reactors;
+
+    seconds = argc > 2 ? atof(argv[2]) : 2.0;
+    signal(SIGPIPE, SIG_IGN);
+    srv.sin_family = AF_INET;
+    srv.sin_port = htons(BENCH_PORT);
+    srv.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    printf("%ld CPUs, %zu connections per client thread, %.1f s per phase\n",
+           cpus, connections, seconds);
+    printf("%8s %14s %14s\n", "reactors", "conn/s", "msgs/s");
+    for (reactors = 1; reactors <= max_reactors; reactors *= 2)
+    {
+        run(reactors, connections);
+        if (reactors < max_reactors && reactors * 2 > max_reactors)
+        {
+            run(max_reactors, connections);
+        }
+    }
+    return 0;
+}
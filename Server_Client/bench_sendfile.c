@@ -0,0 +1,341 @@
+/*
+ * File-serving benchmark for reactor_send_file().
+ *
+ * Writes a [megabytes] MiB temporary file, then forks a server that sends
+ * the whole file to every connection and downloads it [downloads] times,
+ * [parallel] connections at a time, reading into a 256 KiB buffer.
+ * Servers:
+ *
+ *  sendfile  a reactor that queues the file with reactor_send_file() from
+ *            on_open; partial sends resume on writability (epoll and
+ *            io_uring)
+ *  copy      the usual loop, one blocking connection at a time: read() 64
+ *            KiB of the file, send() it, repeat
+ *
+ * The table shows download throughput and the CPU time the server spent
+ * per GiB (getrusage() in the server process, user + system).
+ *
+ * Build: gcc -O2 Reactor.c Reactor_uring.c Frame.c Buffer_pool.c Timer_wheel.c bench_sendfile.c -o bench_sendfile
+ * Usage: ./bench_sendfile [megabytes] [downloads] [parallel]
+ */
+
+#define _GNU_SOURCE
+#include "reactor.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#define BENCH_PORT      9991
+#define COPY_CHUNK      (64 * 1024)
+#define CLIENT_CHUNK    (256 * 1024)
+
+static Reactor reactor;
+static const char* file_path;
+static size_t file_size;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double cpu_s(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+static void ignore_data(Reactor* r, ReactorConnection* conn, const void* data, size_t length, void* ctx)
+{
+    (void)r; (void)conn; (void)data; (void)length; (void)ctx;
+}
+
+static void serve_file(Reactor* r, ReactorConnection* conn, void* ctx)
+{
+    int fd = open(file_path, O_RDONLY);
+
+    (void)ctx;
+    // A failed send leaves the connection to the client, which sees it
+    // close short of the file size.
+    if (fd < 0 || !reactor_send_file(r, conn, fd, 0, file_size, true))
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        reactor_close(r, conn);
+    }
+}
+
+static void on_signal(int signo)
+{
+    (void)signo;
+    reactor_stop(&reactor);
+}
+
+static int run_reactor(ReactorBackend backend, int report_pipe)
+{
+    ReactorConfig config = { 0 };
+    double cpu;
+
+    config.address = "127.0.0.1";
+    config.port = BENCH_PORT;
+    config.backend = backend;
+    config.on_data = ignore_data;
+    config.on_open = serve_file;
+    if (!reactor_initialize(&reactor, &config))
+    {
+        perror("reactor_initialize");
+        return 1;
+    }
+    signal(SIGTERM, on_signal);
+    cpu = 0;
+    if (write(report_pipe, &cpu, sizeof(cpu)) != sizeof(cpu))
+    {
+        return 1;
+    }
+    cpu = cpu_s();
+    reactor_run(&reactor);
+    cpu = cpu_s() - cpu;
+    reactor_deinitialize(&reactor);
+    return write(report_pipe, &cpu, sizeof(cpu)) == sizeof(cpu) ? 0 : 1;
+}
+
+static int run_copy(size_t downloads, int report_pipe)
+{
+    struct sockaddr_in addr;
+    char* buffer = malloc(COPY_CHUNK);
+    int one = 1, listener = socket(AF_INET, SOCK_STREAM, 0);
+    double cpu = 0;
+    size_t i;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(BENCH_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 128) < 0)
+    {
+        perror("listen");
+        return 1;
+    }
+    if (write(report_pipe, &cpu, sizeof(cpu)) != sizeof(cpu))
+    {
+        return 1;
+    }
+    cpu = cpu_s();
+    for (i = 0; i < downloads; i++)
+    {
+        int conn = accept(listener, NULL, NULL);
+        int fd = open(file_path, O_RDONLY);
+        ssize_t n;
+
+        while (conn >= 0 && fd >= 0 && (n = read(fd, buffer, COPY_CHUNK)) > 0)
+        {
+            ssize_t sent = 0;
+            while (sent < n)
+            {
+                ssize_t m = send(conn, buffer + sent, (size_t)(n - sent), MSG_NOSIGNAL);
+                if (m < 0)
+                {
+                    break;
+                }
+                sent += m;
+            }
+            if (sent < n)
+            {
+                break;
+            }
+        }
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        if (conn >= 0)
+        {
+            close(conn);
+        }
+    }
+    cpu = cpu_s() - cpu;
+    close(listener);
+    free(buffer);
+    return write(report_pipe, &cpu, sizeof(cpu)) == sizeof(cpu) ? 0 : 1;
+}
+
+static int connect_server(void)
+{
+    struct sockaddr_in srv;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    memset(&srv, 0, sizeof(srv));
+    srv.sin_family = AF_INET;
+    srv.sin_port = htons(BENCH_PORT);
+    srv.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd >= 0 && connect(fd, (struct sockaddr*)&srv, sizeof(srv)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Downloads the file over every connection in fds until all have it.
+static size_t download(int* fds, size_t count, char* buffer)
+{
+    struct pollfd* polls = calloc(count, sizeof(*polls));
+    size_t* received = calloc(count, sizeof(*received));
+    size_t i, open_count = 0, complete = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        polls[i].fd = fds[i];
+        polls[i].events = POLLIN;
+        open_count += fds[i] >= 0;
+    }
+    while (open_count > 0 && poll(polls, count, -1) >= 0)
+    {
+        for (i = 0; i < count; i++)
+        {
+            ssize_t n;
+
+            if (polls[i].fd < 0 || polls[i].revents == 0)
+            {
+                continue;
+            }
+            n = recv(polls[i].fd, buffer, CLIENT_CHUNK, MSG_DONTWAIT);
+            if (n > 0)
+            {
+                received[i] += (size_t)n;
+            }
+            if (received[i] == file_size || n == 0 ||
+                (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            {
+                close(polls[i].fd);
+                polls[i].fd = -1;
+                open_count--;
+            }
+        }
+    }
+    for (i = 0; i < count; i++)
+    {
+        complete += received[i] == file_size;
+        if (polls[i].fd >= 0)
+        {
+            close(polls[i].fd);
+        }
+    }
+    free(received);
+    free(polls);
+    return complete;
+}
+
+static void run(const char* name, int mode, size_t downloads, size_t parallel)
+{
+    char* buffer = malloc(CLIENT_CHUNK);
+    int pipe_fds[2], status, *fds = calloc(parallel, sizeof(*fds));
+    size_t i, started = 0, complete = 0;
+    double cpu, start, elapsed;
+    pid_t child;
+
+    if (pipe(pipe_fds) < 0)
+    {
+        return;
+    }
+    fflush(stdout);
+    child = fork();
+    if (child == 0)
+    {
+        close(pipe_fds[0]);
+        exit(mode == 0 ? run_copy(downloads, pipe_fds[1])
+                       : run_reactor(mode == 1 ? REACTOR_BACKEND_EPOLL : REACTOR_BACKEND_IO_URING, pipe_fds[1]));
+    }
+    close(pipe_fds[1]);
+    if (read(pipe_fds[0], &cpu, sizeof(cpu)) != sizeof(cpu))
+    {
+        waitpid(child, &status, 0);
+        close(pipe_fds[0]);
+        return;
+    }
+
+    start = now_s();
+    while (started < downloads)
+    {
+        // The copy server takes one connection at a time.
+        size_t batch = mode == 0 ? 1 : (downloads - started < parallel ? downloads - started : parallel);
+
+        for (i = 0; i < batch; i++)
+        {
+            fds[i] = connect_server();
+        }
+        complete += download(fds, batch, buffer);
+        started += batch;
+    }
+    elapsed = now_s() - start;
+
+    if (mode != 0)
+    {
+        kill(child, SIGTERM);
+    }
+    if (read(pipe_fds[0], &cpu, sizeof(cpu)) == sizeof(cpu))
+    {
+        double gib = (double)file_size * complete / (1 << 30);
+        printf("%-16s %8.2f GiB/s   server CPU %7.1f ms/GiB   %zu/%zu complete\n",
+               name, gib / elapsed, gib > 0 ? cpu * 1e3 / gib : 0.0, complete, downloads);
+    }
+    waitpid(child, &status, 0);
+    close(pipe_fds[0]);
+    free(fds);
+    free(buffer);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 256;
+    size_t downloads = argc > 2 ? strtoul(argv[2], NULL, 10) : 16;
+    size_t parallel = argc > 3 ? strtoul(argv[3], NULL, 10) : 4;
+    char path[] = "/tmp/bench_sendfile_XXXXXX";
+    char* block = malloc(1 << 20);
+    size_t i;
+    int fd = mkstemp(path);
+
+    if (fd < 0 || parallel == 0)
+    {
+        perror("mkstemp");
+        return 1;
+    }
+    memset(block, 'x', 1 << 20);
+    for (i = 0; i < megabytes; i++)
+    {
+        if (write(fd, block, 1 << 20) != 1 << 20)
+        {
+            perror("write");
+            return 1;
+        }
+    }
+    close(fd);
+    free(block);
+    file_path = path;
+    file_size = megabytes << 20;
+
+    signal(SIGPIPE, SIG_IGN);
+    printf("%zu MiB file, %zu downloads, %zu in parallel\n", megabytes, downloads, parallel);
+    run("copy", 0, downloads, parallel);
+    run("sendfile epoll", 1, downloads, parallel);
+    run("sendfile uring", 2, downloads, parallel);
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * Idle-timer benchmark for the timing wheel (Timer_wheel.c).
+ *
+ * [connections] timers, each pushed out by the idle timeout (300 ticks,
+ * 30 s at the reactor's 100 ms tick) on activity. Activity hits random
+ * connections of the busy half; the other half stays idle and keeps
+ * expiring (and is re-armed). The clock advances one tick every
+ * [connections]/16 updates. Per update:
+ *
+ *  heap      binary min-heap with a position index, the usual priority
+ *            queue: O(log n) sift on every update
+ *  wheel     timer_wheel_schedule() on every update, O(1)
+ *  lazy      what the reactor does: an update only stores the deadline,
+ *            and an entry that fires early is re-placed at expiry
+ *
+ * Then a batch expiry: every timer due on the same tick, one advance.
+ *
+ * Build: gcc -O2 Timer_wheel.c bench_timers.c -o bench_timers
+ * Usage: ./bench_timers [connections] [updates]
+ */
+
+#include "timer_wheel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define IDLE_TICKS    300
+
+typedef struct Connection
+{
+    TimerWheelEntry idle;
+    uint64_t deadline;
+    size_t heap_index;
+}Connection;
+
+typedef struct Heap
+{
+    Connection** items;
+    size_t count;
+}Heap;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static Connection* owner(TimerWheelEntry* entry)
+{
+    return (Connection*)((char*)entry - offsetof(Connection, idle));
+}
+
+static void heap_swap(Heap* h, size_t a, size_t b)
+{
+    Connection* t = h->items[a];
+    h->items[a] = h->items[b];
+    h->items[b] = t;
+    h->items[a]->heap_index = a;
+    h->items[b]->heap_index = b;
+}
+
+static void heap_fix(Heap* h, size_t i)
+{
+    while (i > 0 && h->items[(i - 1) / 2]->deadline > h->items[i]->deadline)
+    {
+        heap_swap(h, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    for (;;)
+    {
+        size_t l = 2 * i + 1, r = l + 1, m = i;
+        if (l < h->count && h->items[l]->deadline < h->items[m]->deadline) m = l;
+        if (r < h->count && h->items[r]->deadline < h->items[m]->deadline) m = r;
+        if (m == i)
+        {
+            break;
+        }
+        heap_swap(h, i, m);
+        i = m;
+    }
+}
+
+static size_t heap_expire(Heap* h, uint64_t now)
+{
+    size_t expired = 0;
+
+    while (h->count > 0 && h->items[0]->deadline <= now)
+    {
+        // Re-armed rather than removed, so the population stays constant.
+        h->items[0]->deadline = now + IDLE_TICKS;
+        heap_fix(h, 0);
+        expired++;
+    }
+    return expired;
+}
+
+static size_t wheel_expire(TimerWheel* wheel, uint64_t now, int lazy)
+{
+    TimerWheelEntry* entry = timer_wheel_advance(wheel, now);
+    size_t expired = 0;
+
+    while (entry)
+    {
+        TimerWheelEntry* next = entry->next;
+        Connection* c = owner(entry);
+
+        if (lazy && c->deadline > now)
+        {
+            timer_wheel_schedule(wheel, entry, c->deadline);
+        }
+        else
+        {
+            c->deadline = now + IDLE_TICKS;
+            timer_wheel_schedule(wheel, entry, c->deadline);
+            expired++;
+        }
+        entry = next;
+    }
+    return expired;
+}
+
+static void run(const char* name, int mode, Connection* conns, size_t count, size_t updates)
+{
+    TimerWheel wheel;
+    Heap heap;
+    size_t i, expired = 0, every = count / 16 ? count / 16 : 1;
+    uint64_t now = 0;
+    double start, elapsed;
+
+    timer_wheel_initialize(&wheel, 0);
+    heap.items = malloc(count * sizeof(*heap.items));
+    heap.count = 0;
+    for (i = 0; i < count; i++)
+    {
+        timer_wheel_entry_initialize(&conns[i].idle);
+        conns[i].deadline = IDLE_TICKS + i % IDLE_TICKS;
+        if (mode == 0)
+        {
+            conns[i].heap_index = heap.count;
+            heap.items[heap.count++] = &conns[i];
+            heap_fix(&heap, heap.count - 1);
+        }
+        else
+        {
+            timer_wheel_schedule(&wheel, &conns[i].idle, conns[i].deadline);
+        }
+    }
+
+    srand(11);
+    start = now_s();
+    for (i = 0; i < updates; i++)
+    {
+        Connection* c = &conns[(size_t)rand() % (count / 2 + 1)];
+
+        c->deadline = now + IDLE_TICKS;
+        if (mode == 0)
+        {
+            heap_fix(&heap, c->heap_index);
+        }
+        else if (mode == 1)
+        {
+            timer_wheel_schedule(&wheel, &c->idle, c->deadline);
+        }
+        if (i % every == 0)
+        {
+            now++;
+            expired += mode == 0 ? heap_expire(&heap, now) : wheel_expire(&wheel, now, mode == 2);
+        }
+    }
+    elapsed = now_s() - start;
+    printf("%-6s %8.1f ns/update   %zu expired over %llu ticks\n",
+           name, elapsed * 1e9 / updates, expired, (unsigned long long)now);
+    free(heap.items);
+}
+
+static void batch_expiry(Connection* conns, size_t count)
+{
+    TimerWheel wheel;
+    TimerWheelEntry* entry;
+    size_t i, expired = 0;
+    double start;
+
+    timer_wheel_initialize(&wheel, 0);
+    for (i = 0; i < count; i++)
+    {
+        timer_wheel_entry_initialize(&conns[i].idle);
+        timer_wheel_schedule(&wheel, &conns[i].idle, IDLE_TICKS);
+    }
+    start = now_s();
+    for (entry = timer_wheel_advance(&wheel, IDLE_TICKS); entry; entry = entry->next)
+    {
+        expired++;
+    }
+    printf("batch  %8.1f ns/timer   %zu expired in one advance\n", (now_s() - start) * 1e9 / count, expired);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+    size_t updates = argc > 2 ? strtoul(argv[2], NULL, 10) : 20000000;
+    Connection* conns = calloc(count, sizeof(*conns));
+
+    printf("%zu connections, %zu updates\n", count, updates);
+    run("heap", 0, conns, count, updates);
+    run("wheel", 1, conns, count, updates);
+    run("lazy", 2, conns, count, updates);
+    batch_expiry(conns, count);
+    free(conns);
+    return 0;
+}
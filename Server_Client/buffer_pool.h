@@ -0,0 +1,56 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Slab allocator for fixed-size I/O buffers. Buffers are carved out of
+// large slabs mapped SLAB_BUFFERS at a time and recycled through a LIFO
+// free list, so a connection can take a buffer when data starts to flow
+// and give it back when it is drained without going through malloc; the
+// most recently released (cache-warm) buffer is handed out next.
+//
+// In mirrored mode every buffer is mapped twice back to back, like the
+// FrameReader ring (frame.h), so it can serve as a ring directly.
+//
+// Not thread-safe: one pool per reactor thread.
+
+#define BUFFER_POOL_DEFAULT_SIZE       65536
+#define BUFFER_POOL_SLAB_BUFFERS       64
+
+typedef struct BufferPool
+{
+    size_t buffer_size;        // power of two, multiple of the page size
+    size_t slab_buffers;
+    bool mirrored;
+
+    void* free_list;           // next pointer in the first bytes of a buffer
+    unsigned char* carve;      // next never-used buffer in the newest slab
+    size_t carve_left;
+    unsigned char** slabs;
+    size_t slab_count;
+    size_t slab_capacity;
+
+    size_t buffers;            // carved so far
+    size_t in_use;
+    unsigned long long acquired;
+}BufferPool;
+
+// buffer_size 0 = BUFFER_POOL_DEFAULT_SIZE, slab_buffers 0 =
+// BUFFER_POOL_SLAB_BUFFERS. No memory is mapped until the first acquire.
+bool buffer_pool_initialize(BufferPool* pool, size_t buffer_size, size_t slab_buffers, bool mirrored);
+// Unmaps every slab; buffers still in use become invalid.
+void buffer_pool_deinitialize(BufferPool* pool);
+// NULL if a new slab could not be mapped.
+void* buffer_pool_acquire(BufferPool* pool);
+void buffer_pool_release(BufferPool* pool, void* buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUFFER_POOL_H
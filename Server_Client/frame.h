@@ -0,0 +1,89 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Length-prefixed framing: every frame is a 4-byte big-endian payload
+// length followed by the payload.
+//
+// FrameReader hands each complete frame to a callback as a (pointer,
+// length) view without copying it. Frames that arrive whole inside a
+// received chunk are passed straight out of that chunk; only a frame split
+// across reads is gathered, in a per-connection ring buffer. The ring is
+// mapped twice back to back, so a frame that wraps around its end is still
+// contiguous in memory. Bytes can also be received directly into the ring
+// (frame_reader_space/commit), which avoids even that one copy.
+//
+// With a pool (mirrored BufferPool, buffer_pool.h), the ring is taken from
+// the pool when a frame is split and handed back as soon as no bytes are
+// pending, so an idle connection holds no ring at all.
+
+#define FRAME_HEADER_SIZE            4
+#define FRAME_DEFAULT_MAX_LENGTH     (16u << 20)
+#define FRAME_RING_MIN_SIZE          65536
+
+struct BufferPool;
+
+// Returns false to stop parsing, e.g. because the handler closed the
+// connection that owns the reader; the reader is not touched afterwards.
+typedef bool (*FrameHandler)(void* ctx, const void* payload, size_t length);
+
+typedef struct FrameReader
+{
+    unsigned char* ring;       // NULL until a frame is split across reads
+    size_t capacity;           // power of two, multiple of the page size
+    size_t head;               // offset of the first pending byte
+    size_t size;               // pending bytes
+    size_t max_length;
+    struct BufferPool* pool;   // optional, see frame_reader_use_pool()
+    bool pooled;               // ring came from pool
+}FrameReader;
+
+void frame_reader_initialize(FrameReader* reader, size_t max_length);
+// Takes rings up to the pool's buffer size from pool (which must be
+// mirrored) and returns them once drained. Set before the first feed.
+void frame_reader_use_pool(FrameReader* reader, struct BufferPool* pool);
+void frame_reader_deinitialize(FrameReader* reader);
+
+// Parses a received chunk. Returns false if a handler stopped parsing, if
+// a frame announced more than max_length bytes (a protocol error: the
+// stream cannot be resynchronized) or if the ring could not be grown.
+bool frame_reader_feed(FrameReader* reader, const void* data, size_t length,
+                       FrameHandler handler, void* ctx);
+
+// Contiguous free space after the pending bytes, for receiving directly
+// into the ring, or NULL while no split frame is pending.
+void* frame_reader_space(FrameReader* reader, size_t* space);
+// Accounts for length bytes written into the space and parses them.
+bool frame_reader_commit(FrameReader* reader, size_t length, FrameHandler handler, void* ctx);
+
+static inline bool frame_reader_pending(const FrameReader* reader)
+{
+    return reader->size > 0;
+}
+
+static inline void frame_write_header(unsigned char header[FRAME_HEADER_SIZE], uint32_t length)
+{
+    header[0] = (unsigned char)(length >> 24);
+    header[1] = (unsigned char)(length >> 16);
+    header[2] = (unsigned char)(length >> 8);
+    header[3] = (unsigned char)length;
+}
+
+static inline uint32_t frame_read_header(const unsigned char header[FRAME_HEADER_SIZE])
+{
+    return (uint32_t)header[0] << 24 | (uint32_t)header[1] << 16 |
+           (uint32_t)header[2] << 8 | header[3];
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAME_H
@@ -0,0 +1,78 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// HDR-style latency histogram in nanoseconds: values below 2^SUB_BITS get
+// a bucket each, every power of two above is split into 2^SUB_BITS linear
+// buckets, so a bucket is never wider than 1/32 (3%) of the values in it.
+// Covers up to 2^40 ns (18 minutes); longer values land in the last
+// bucket. Fixed size, no allocation, O(1) record.
+//
+// One writer, any number of readers: the owner records with plain adds
+// published by relaxed atomic stores, readers load each count atomically.
+// A snapshot taken while recording is not a single instant, but every
+// count in it is one that really existed.
+
+#define LATENCY_SUB_BITS    5
+#define LATENCY_MAX_BITS    40
+#define LATENCY_BUCKETS     ((LATENCY_MAX_BITS - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS)
+
+typedef struct LatencyHistogram
+{
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t count;
+    uint64_t max;
+}LatencyHistogram;
+
+static inline unsigned int latency_bucket(uint64_t ns)
+{
+    unsigned int shift;
+
+    if (ns < (1u << LATENCY_SUB_BITS))
+    {
+        return (unsigned int)ns;
+    }
+    if (ns >= 1ull << LATENCY_MAX_BITS)
+    {
+        return LATENCY_BUCKETS - 1;
+    }
+    // The top SUB_BITS + 1 bits pick the bucket within the power of two.
+    shift = (unsigned int)(63 - __builtin_clzll(ns)) - LATENCY_SUB_BITS;
+    return (shift << LATENCY_SUB_BITS) + (unsigned int)(ns >> shift);
+}
+
+// Largest value that falls into bucket.
+static inline uint64_t latency_bucket_limit(unsigned int bucket)
+{
+    unsigned int group = bucket >> LATENCY_SUB_BITS;
+
+    if (group == 0)
+    {
+        return bucket;
+    }
+    return (((uint64_t)(bucket & ((1u << LATENCY_SUB_BITS) - 1)) + (1u << LATENCY_SUB_BITS) + 1) << (group - 1)) - 1;
+}
+
+// Owner thread only.
+static inline void latency_histogram_record(LatencyHistogram* histogram, uint64_t ns)
+{
+    uint64_t* bucket = &histogram->counts[latency_bucket(ns)];
+
+    __atomic_store_n(bucket, *bucket + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&histogram->count, histogram->count + 1, __ATOMIC_RELAXED);
+    if (ns > histogram->max)
+    {
+        __atomic_store_n(&histogram->max, ns, __ATOMIC_RELAXED);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LATENCY_HISTOGRAM_H
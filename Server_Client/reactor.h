@@ -0,0 +1,196 @@
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "frame.h"
+#include "buffer_pool.h"
+#include "latency_histogram.h"
+#include "timer_wheel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Linux event loop for the multi-client server: one edge-triggered epoll
+// set, a non-blocking listener and a connection table indexed by fd that
+// grows with the highest fd seen. A loop iteration only touches sockets
+// that are ready, so idle clients cost nothing but their table entry.
+//
+// Alternatively the loop runs on io_uring (Reactor_uring.c): multishot
+// accept and multishot recv into a ring of provided buffers, so under load
+// one io_uring_enter() delivers many messages for many connections.
+
+#define REACTOR_DEFAULT_BACKLOG      4096
+#define REACTOR_DEFAULT_READ_SIZE    65536
+#define REACTOR_MAX_EVENTS           256
+#define REACTOR_TIMER_TICK_MS        100    // idle timeout resolution
+
+typedef struct Reactor Reactor;
+typedef struct ReactorUring ReactorUring;
+
+typedef enum ReactorBackend
+{
+    REACTOR_BACKEND_EPOLL,
+    REACTOR_BACKEND_IO_URING      // falls back to epoll when unavailable
+}ReactorBackend;
+
+// A file range queued by reactor_send_file().
+typedef struct ReactorFileSend
+{
+    struct ReactorFileSend* next;
+    int fd;
+    bool close_fd;
+    off_t offset;
+    size_t remaining;
+    unsigned long long output_mark;    // output bytes that go before it
+}ReactorFileSend;
+
+typedef struct ReactorConnection
+{
+    int fd;
+    uint32_t id;           // tells a reused fd apart in io_uring completions
+    void* user;            // free for the application
+    FrameReader frames;    // used when the reactor has an on_frame handler
+
+    // Bytes reactor_send() could not write yet; flushed when the socket
+    // becomes writable again. Only allocated while bytes are queued,
+    // from the reactor's buffer pool unless they outgrow one buffer.
+    unsigned char* output;
+    size_t output_head;
+    size_t output_size;
+    size_t output_capacity;
+    bool output_pooled;
+    bool want_write;
+    // Files go out in order with the bytes around them: a file starts once
+    // output_sent reaches its output_mark.
+    ReactorFileSend* files;
+    ReactorFileSend* files_tail;
+    unsigned long long output_queued;
+    unsigned long long output_sent;
+
+    // Idle timeout: activity only moves idle_deadline (in timer ticks);
+    // the wheel entry is re-placed when it fires early.
+    TimerWheelEntry idle;
+    uint64_t idle_deadline;
+}ReactorConnection;
+
+// Called for every chunk read from a connection. data is only valid until
+// the handler returns. The handler may call reactor_close() on conn.
+typedef void (*ReactorDataHandler)(Reactor* reactor, ReactorConnection* conn,
+                                   const void* data, size_t length, void* ctx);
+// Same contract, called once per complete length-prefixed frame (frame.h)
+// with the payload only.
+typedef ReactorDataHandler ReactorFrameHandler;
+// Called once a connection has been accepted, and once right before it is
+// closed (also by reactor_deinitialize()). on_open may reject the
+// connection with reactor_close(); on_close must not call it.
+typedef void (*ReactorConnectionHandler)(Reactor* reactor, ReactorConnection* conn, void* ctx);
+
+typedef struct ReactorConfig
+{
+    const char* address;       // NULL = any address
+    uint16_t port;
+    int backlog;               // 0 = REACTOR_DEFAULT_BACKLOG
+    bool reuse_port;           // SO_REUSEPORT, one listener per reactor
+    ReactorBackend backend;
+    size_t read_size;          // 0 = REACTOR_DEFAULT_READ_SIZE
+    ReactorDataHandler on_data;
+    // When set, received bytes are decoded as frames and on_data is not
+    // called. A frame longer than max_frame closes the connection.
+    ReactorFrameHandler on_frame;
+    size_t max_frame;          // 0 = FRAME_DEFAULT_MAX_LENGTH
+    ReactorConnectionHandler on_open;     // optional
+    ReactorConnectionHandler on_close;    // optional
+    // Connections without any received bytes for this long are closed.
+    // 0 = never.
+    unsigned int idle_timeout_ms;
+    void* ctx;
+}ReactorConfig;
+
+struct Reactor
+{
+    unsigned int id;           // index within a ReactorPool, 0 otherwise
+    ReactorBackend backend;    // the backend actually in use
+    int listen_fd;
+    int epoll_fd;
+    int wake_fd;               // eventfd, reactor_stop() writes to it
+    int spare_fd;              // released to shed a connection on EMFILE
+    int timer_fd;              // ticks the idle wheel, -1 without timeout
+    ReactorUring* uring;       // NULL on the epoll backend
+
+    ReactorConnection** connections;    // indexed by fd, NULL = free
+    size_t capacity;
+    size_t active;
+    uint32_t next_id;
+
+    unsigned char* read_buffer;
+    size_t read_size;
+    // Mirrored I/O buffers lent to connections while data is in flight:
+    // frame rings for split frames and queued output.
+    BufferPool buffers;
+    TimerWheel timers;         // one tick = REACTOR_TIMER_TICK_MS
+    uint64_t idle_ticks;
+    ReactorDataHandler on_data;
+    ReactorFrameHandler on_frame;
+    size_t max_frame;
+    ReactorConnectionHandler on_open;
+    ReactorConnectionHandler on_close;
+    void* ctx;
+    bool stopping;
+
+    uint64_t arrival_ns;       // when the bytes being dispatched came in
+    unsigned long long syscalls;    // wait, accept and recv calls in the loop
+
+    // Written by the reactor thread only and published with relaxed atomic
+    // stores (as is active), so other threads may read them at any time;
+    // see reactor_stats.h.
+    unsigned long long accepted;
+    unsigned long long closed;
+    unsigned long long timed_out;
+    unsigned long long bytes_in;
+    unsigned long long bytes_out;
+    unsigned long long frames;
+    LatencyHistogram latency;  // frame arrival to on_frame return
+};
+
+bool reactor_initialize(Reactor* reactor, const ReactorConfig* config);
+// Closes the listener and every open connection.
+void reactor_deinitialize(Reactor* reactor);
+// Runs the loop on the calling thread until reactor_stop(). Returns 0, or
+// -1 if epoll_wait() failed.
+int reactor_run(Reactor* reactor);
+// Safe from any thread and from signal handlers.
+void reactor_stop(Reactor* reactor);
+void reactor_close(Reactor* reactor, ReactorConnection* conn);
+
+// Pushes conn's idle deadline out by the idle timeout. Called for every
+// read; O(1) and only a store, so handlers may call it for other activity.
+static inline void reactor_touch(Reactor* reactor, ReactorConnection* conn)
+{
+    conn->idle_deadline = reactor->timers.now + reactor->idle_ticks;
+}
+
+// Sends now as far as the socket takes it and queues the rest, so callers
+// never block and never see partial writes. Returns false if the
+// connection failed or the rest could not be queued; the caller then
+// closes it. Reactor thread only.
+bool reactor_send(Reactor* reactor, ReactorConnection* conn, const void* data, size_t length);
+bool reactor_sendv(Reactor* reactor, ReactorConnection* conn, const struct iovec* iov, int count);
+// Streams length bytes of file_fd from offset with sendfile(), so the data
+// goes from the page cache to the socket without passing through user
+// space. Ordered with reactor_send() like any other output; what the
+// socket does not take now is resumed when it becomes writable. With
+// close_file the reactor closes file_fd once sent or when the connection
+// closes. Returns false like reactor_send(); file_fd is then not closed.
+bool reactor_send_file(Reactor* reactor, ReactorConnection* conn, int file_fd, off_t offset,
+                       size_t length, bool close_file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REACTOR_H
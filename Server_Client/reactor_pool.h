@@ -0,0 +1,38 @@
+#ifndef REACTOR_POOL_H
+#define REACTOR_POOL_H
+
+#include "reactor.h"
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// N independent reactors, one thread each. Every reactor has its own
+// SO_REUSEPORT listener on the same port, its own epoll set and its own
+// connection table; the kernel spreads incoming connections across the
+// listeners by flow hash, so accept and read never contend on shared
+// state. A connection stays on the reactor that accepted it.
+
+typedef struct ReactorPool
+{
+    Reactor* reactors;
+    pthread_t* threads;
+    size_t count;
+    size_t running;
+}ReactorPool;
+
+// count = 0 uses one reactor per online CPU. config->port must be set:
+// with port 0 every listener would get its own ephemeral port.
+bool reactor_pool_initialize(ReactorPool* pool, const ReactorConfig* config, size_t count);
+// Starts one thread per reactor, pinned to CPU (id % CPUs).
+bool reactor_pool_start(ReactorPool* pool);
+// Stops every reactor and joins the threads.
+void reactor_pool_stop(ReactorPool* pool);
+void reactor_pool_deinitialize(ReactorPool* pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REACTOR_POOL_H
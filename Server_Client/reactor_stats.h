@@ -0,0 +1,65 @@
+#ifndef REACTOR_STATS_H
+#define REACTOR_STATS_H
+
+#include "reactor.h"
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Read side of the reactor counters. Reactors publish their counters and
+// latency histogram with relaxed atomic stores; a snapshot loads them from
+// any thread without stopping or slowing the reactor.
+//
+// The stats endpoint serves snapshots on a local Unix socket from its own
+// thread: every connection gets one text report and is closed, e.g.
+//     socat - UNIX-CONNECT:/tmp/server.stats
+
+typedef struct ReactorStatsSnapshot
+{
+    uint64_t time_ns;          // CLOCK_MONOTONIC
+    unsigned long long active;
+    unsigned long long accepted;
+    unsigned long long closed;
+    unsigned long long timed_out;
+    unsigned long long bytes_in;
+    unsigned long long bytes_out;
+    unsigned long long frames;
+    LatencyHistogram latency;
+}ReactorStatsSnapshot;
+
+void reactor_stats_snapshot(const Reactor* reactor, ReactorStatsSnapshot* snapshot);
+// Adds from's counts to into, e.g. for a total over a ReactorPool.
+void reactor_stats_merge(ReactorStatsSnapshot* into, const ReactorStatsSnapshot* from);
+// Upper bound (ns) of the bucket holding the given fraction of the samples;
+// 0 if there are none.
+uint64_t reactor_stats_percentile(const LatencyHistogram* latency, double fraction);
+// Writes a text report like snprintf(). With previous (may be NULL) rates
+// are given over the time since it was taken.
+int reactor_stats_format(const char* name, const ReactorStatsSnapshot* snapshot,
+                         const ReactorStatsSnapshot* previous, char* out, size_t size);
+
+typedef struct ReactorStatsEndpoint
+{
+    int listen_fd;
+    int wake_fd;
+    pthread_t thread;
+    Reactor* reactors;
+    size_t count;
+    ReactorStatsSnapshot* previous;    // per reactor plus the total, from the last report
+    char path[108];
+}ReactorStatsEndpoint;
+
+// Serves reports for reactors[0..count) on the Unix socket at path. A
+// stale socket at path is replaced.
+bool reactor_stats_endpoint_start(ReactorStatsEndpoint* endpoint, const char* path,
+                                  Reactor* reactors, size_t count);
+// Joins the thread and removes the socket.
+void reactor_stats_endpoint_stop(ReactorStatsEndpoint* endpoint);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REACTOR_STATS_H
@@ -0,0 +1,33 @@
+#ifndef REACTOR_URING_H
+#define REACTOR_URING_H
+
+#include "reactor.h"
+
+// Internal interface between Reactor.c and the io_uring backend in
+// Reactor_uring.c; not for applications.
+
+#define REACTOR_URING_ENTRIES        1024
+#define REACTOR_URING_BUFFERS        1024    // power of two
+#define REACTOR_URING_BUFFER_SIZE    4096
+
+// Returns false when io_uring (or a feature it needs: provided buffer
+// rings, multishot accept) is unavailable; the caller falls back to epoll.
+bool reactor_uring_initialize(Reactor* reactor);
+void reactor_uring_deinitialize(Reactor* reactor);
+int reactor_uring_run(Reactor* reactor);
+bool reactor_uring_watch(Reactor* reactor, ReactorConnection* conn);
+// One-shot POLLOUT for a connection with queued output.
+bool reactor_uring_watch_write(Reactor* reactor, ReactorConnection* conn);
+
+// Provided by Reactor.c for both backends.
+ReactorConnection* reactor_add_connection(Reactor* reactor, int fd);
+// Hands received bytes to on_data, or through the connection's FrameReader
+// to on_frame.
+void reactor_deliver(Reactor* reactor, ReactorConnection* conn, const void* data, size_t length);
+// Writes queued output once the socket is writable; re-arms or closes.
+void reactor_handle_write(Reactor* reactor, ReactorConnection* conn);
+void reactor_shed_connection(Reactor* reactor);
+// Advances the idle wheel and closes the connections that timed out.
+void reactor_handle_timer(Reactor* reactor);
+
+#endif // REACTOR_URING_H
@@ -0,0 +1,98 @@
+#ifndef SERVER_EVENTS_H
+#define SERVER_EVENTS_H
+
+#include "reactor.h"
+#include "../Event_Notifier/event_notifier.h"
+#include "../Event_Notifier/event_dispatcher.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Publishes what the reactors see (connection opened, frame received,
+// connection closed) through one Event, so application logic subscribes
+// with the Event API instead of living in the reactor callbacks. Every
+// payload starts with a ServerEvent, whose header.type is one of the
+// SERVER_EVENT_* bits; subscribe with that as filter_mask to get only
+// some kinds.
+//
+// Handlers run inline on the reactor thread (workers == 0), or are handed
+// off to worker threads, each with its own EventDispatcher queue. Handing
+// off copies the frame and costs a queue hop, which the dispatchers measure
+// (server_events_get_stats()); in exchange a slow handler no longer
+// stalls every connection of its reactor.
+//
+// Ordering: the events of one connection reach the handlers one at a time
+// and in the order the reactor saw them, OPENED first and CLOSED last, in
+// both modes. After a handoff that holds because a connection always goes
+// to the same worker; events of different connections on different workers
+// are unordered with respect to each other. A drop policy only ever drops
+// MESSAGE events: OPENED and CLOSED wait for room in the queue, stalling
+// the reactor if they have to.
+
+typedef enum ServerEventType
+{
+    SERVER_EVENT_OPENED  = 1u << 0,
+    SERVER_EVENT_MESSAGE = 1u << 1,
+    SERVER_EVENT_CLOSED  = 1u << 2
+}ServerEventType;
+
+typedef struct ServerEvent
+{
+    EventHeader header;        // type: one ServerEventType
+    unsigned int reactor_id;
+    uint32_t connection_id;    // ReactorConnection.id, unique per reactor
+    int fd;
+    uint32_t length;           // message bytes, 0 for opened/closed
+    // Inline mode only, NULL after a handoff: the frame in the reactor's
+    // buffer and the connection, valid until the handler returns (e.g. to
+    // reply with reactor_send()). Use server_event_data() for the bytes.
+    const void* data;
+    Reactor* reactor;
+    ReactorConnection* conn;
+}ServerEvent;
+
+typedef struct ServerEventsConfig
+{
+    size_t workers;            // 0 = run handlers on the reactor thread
+    size_t queue_capacity;     // handoff queue per worker, 0 = 4096
+    EventBackpressure policy;  // for MESSAGE events when a queue is full
+}ServerEventsConfig;
+
+typedef struct ServerEvents
+{
+    Event event;               // concurrent: every reactor thread notifies
+    EventDispatcher* dispatchers;    // one per worker thread
+    size_t dispatcher_count;
+    bool async;
+    unsigned long long handoff_failures;
+}ServerEvents;
+
+typedef struct ServerEventsStats
+{
+    EventDispatchStats dispatch;    // summed over the workers, all zero inline
+    unsigned long long handoff_failures;
+}ServerEventsStats;
+
+bool server_events_initialize(ServerEvents* events, const ServerEventsConfig* config);
+// Drains the handoff queues; call after the reactors have stopped.
+void server_events_deinitialize(ServerEvents* events);
+// Points config's on_open/on_frame/on_close/ctx at events.
+void server_events_attach(ServerEvents* events, ReactorConfig* config);
+// types: ServerEventType bits, 0 = all.
+EventHandle server_events_subscribe(ServerEvents* events, uint32_t types,
+                                    EventContextHandler handler, void* ctx);
+void server_events_get_stats(ServerEvents* events, ServerEventsStats* stats);
+
+// The message bytes: a view into the reactor's buffer inline, the bytes
+// copied right after the ServerEvent after a handoff.
+static inline const void* server_event_data(const ServerEvent* event)
+{
+    return event->data ? event->data : (const void*)(event + 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SERVER_EVENTS_H
@@ -0,0 +1,66 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Hierarchical timing wheel: TIMER_WHEEL_LEVELS wheels of 64 slots, each
+// level 64 times coarser than the one below, covering 2^24 ticks. Entries
+// are intrusive (embedded in the object they time) and sit in doubly
+// linked slot lists, so scheduling, rescheduling and cancelling are O(1).
+// An entry further out than the top level is parked in its last slot and
+// re-placed whenever that slot comes round.
+//
+// Time is in abstract ticks; the owner decides what a tick is and calls
+// timer_wheel_advance() with the current tick. Not thread-safe.
+
+#define TIMER_WHEEL_BITS      6
+#define TIMER_WHEEL_SLOTS     (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS    4
+
+typedef struct TimerWheelEntry
+{
+    struct TimerWheelEntry* next;
+    struct TimerWheelEntry** pprev;    // NULL while not scheduled
+    uint64_t expires;
+}TimerWheelEntry;
+
+typedef struct TimerWheel
+{
+    uint64_t now;              // last tick processed
+    size_t count;              // scheduled entries
+    TimerWheelEntry* slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+}TimerWheel;
+
+void timer_wheel_initialize(TimerWheel* wheel, uint64_t now);
+// (Re)schedules entry to expire at tick expires; a tick not after now
+// expires on the next advance.
+void timer_wheel_schedule(TimerWheel* wheel, TimerWheelEntry* entry, uint64_t expires);
+void timer_wheel_cancel(TimerWheel* wheel, TimerWheelEntry* entry);
+// Runs the wheel forward to tick now and returns every entry that
+// expired, unscheduled and chained through next, for the caller to handle
+// as one batch.
+TimerWheelEntry* timer_wheel_advance(TimerWheel* wheel, uint64_t now);
+
+static inline void timer_wheel_entry_initialize(TimerWheelEntry* entry)
+{
+    entry->next = NULL;
+    entry->pprev = NULL;
+    entry->expires = 0;
+}
+
+static inline bool timer_wheel_pending(const TimerWheelEntry* entry)
+{
+    return entry->pprev != NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TIMER_WHEEL_H